@@ -9,10 +9,11 @@
 #ifndef APPLICATION_H_
 #define APPLICATION_H_
 
+#include <Board.h>
 #include <HAL/HAL.h>
 
 #define MIN_DIM 2
-#define MAX_DIM 5
+#define MAX_DIM BOARD_MAX_DIM
 #define DEFAULT_DIM 3
 
 #define COORDINATES_FORMAT_L 3
@@ -29,12 +30,28 @@
 
 #define SIDES 4
 
-#define MAX_PLAYERS 2
-#define MAX_TURNS 40
-#define MAX_BOXES 16
+#define MAX_PLAYERS BOARD_MAX_PLAYERS
+#define MAX_TURNS BOARD_MAX_EDGES
+#define MAX_BOXES BOARD_MAX_BOXES
 
 #define NAME_LEN 3
 
+// Pop-up over the game board showing a newly picked baud rate. The board under
+// it is saved and put back when it closes, if the LCD driver can capture it.
+#define POPUP_X0 24
+#define POPUP_Y0 54
+#define POPUP_X1 103
+#define POPUP_Y1 73
+#define POPUP_PIXELS ((POPUP_X1 - POPUP_X0 + 1) * (POPUP_Y1 - POPUP_Y0 + 1))
+#define POPUP_TIME_MS 1000
+
+// Baud choices shown by each color of the Launchpad RGB LED before the
+// BoosterPack RGB LED moves on to the next color
+#define BAUD_GROUP_SIZE 4
+
+// Holding BoosterPack S2 down this long listens for the host's baudrate
+#define AUTO_BAUD_HOLD_MS 1000
+
 typedef enum { TitleScreen, InstructionsScreen, SettingsScreen,
                GameScreen, ResultsScreen } _appGameFSMstate;
 
@@ -53,6 +70,7 @@ typedef struct _Player Player;
 
 struct _Box {
     char coordinates[COORDINATES_LEN + 1];
+    int numCoordinates;  // Characters of the Coordinates Typed So Far
     int boxesToWin;
     int boxesCompleted[MAX_BOXES][2];  // Record of Made Boxes (First Side, If Box is Complete)
     int linesDrawn[MAX_TURNS];  // Record of Existing Lines
@@ -76,11 +94,18 @@ struct _Application {
     _appCursorFSMstate cursorState;
     _appPlayFSMstate playState;
     Settings settings;
+    Board board;
     Player players[MAX_PLAYERS];
     Box boxes;
     int numTurn;
     int numPlayer;
     char rxChar;
+    GFXSaveUnder popup;
+    SWTimer popupTimer;
+    bool popupShown;
+
+    SWTimer autoBaudTimer;  // Started when BoosterPack S2 goes down
+    bool autoBaudArmed;     // S2 is still down and has not started listening
 };
 typedef struct _Application Application;
 
@@ -112,11 +137,18 @@ void Application_sendFirstQuestion(Application* app_p, UART* uart_p);
 void Application_sendInvalidCoordinates(Application* app_p, UART* uart_p);
 void Application_receiveCoordinates(Application* app_p, HAL* hal_p);
 void Application_interpretCoordinates(Application* app_p, HAL* hal_p);
+int  Application_edgeIndex(Application* app_p);
+void Application_playEdge(Application* app_p, HAL* hal_p, int edge);
 bool Application_checkCoordinate(Application* app_p, GFX* gfx_p);
 void Application_checkBoxWon(Application* app_p);
 
+// Opens and closes the baud rate pop-up on the game screen
+void Application_showBaudPopup(Application* app_p, GFX* gfx_p);
+void Application_closeBaudPopup(Application* app_p, GFX* gfx_p);
+
 // Called whenever the UART module needs to be updated
 void Application_updateCommunications(Application* app, HAL* hal);
+void Application_setCommunications(Application* app_p, HAL* hal_p);
 
 // Generic circular increment function
 uint32_t CircularIncrement(uint32_t value, uint32_t maximum);
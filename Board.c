@@ -0,0 +1,284 @@
+/*
+ * Board.c
+ *
+ *  Retained-mode rendering of the game board.
+ */
+
+#include <Board.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static const uint8_t cursorMask[BOARD_CURSOR_SIZE] = { 0xFE, 0x82, 0x82, 0x82, 0x82, 0x82, 0xFE };
+
+/**
+ * Returns the pixel position of the dot at the given board column or row. Dots
+ * sit in the middle of their spacing, 2.5 pixels in from the edge; the math is
+ * done in fixed point so that every build rounds the same way.
+ */
+int Board_dotPixel(int spacing, int index) {
+    return GFX_FIXED_TO_INT(GFX_FIXED(2.5) + spacing * (GFX_FIXED_INT(index) + GFX_FIXED(0.5)));
+}
+
+/**
+ * Works out where every dot and every line of the board goes on screen, so
+ * that drawing a move is a table lookup instead of divisions and fixed point
+ * math. The x spacing comes from the board width and the y spacing from its
+ * height.
+ */
+static void Board_buildLayout(Board* board_p) {
+    BoardLayout* layout = &board_p->layout;
+    int spaceWidth  = 128 / board_p->width - 1;
+    int spaceHeight = 128 / board_p->height - 1;
+
+    int i, j;
+    for (i = 0; i < board_p->width; i++)  layout->dotX[i] = Board_dotPixel(spaceWidth, i);
+    for (j = 0; j < board_p->height; j++) layout->dotY[j] = Board_dotPixel(spaceHeight, j);
+
+    int edge = 0;
+    for (j = 0; j < board_p->height; j++) {
+        // Lines to the right of each dot in this row
+        for (i = 0; i < board_p->width - 1; i++, edge++) {
+            layout->edges[edge].x1 = layout->dotX[i];
+            layout->edges[edge].x2 = layout->dotX[i + 1];
+            layout->edges[edge].y1 = layout->dotY[j];
+            layout->edges[edge].y2 = layout->dotY[j];
+        }
+        if (j == board_p->height - 1) break;
+
+        // Lines down to the next row
+        for (i = 0; i < board_p->width; i++, edge++) {
+            layout->edges[edge].x1 = layout->dotX[i];
+            layout->edges[edge].x2 = layout->dotX[i];
+            layout->edges[edge].y1 = layout->dotY[j];
+            layout->edges[edge].y2 = layout->dotY[j + 1];
+        }
+    }
+}
+
+/**
+ * Works out the color of one pixel of the board as last drawn: background,
+ * then box fills, then dots, then lines, in the order Board_render() paints
+ * them.
+ */
+static uint16_t Board_pixelColor(Board* board_p, int x, int y) {
+    const BoardLayout* layout = &board_p->layout;
+    const BoardScene* shown = &board_p->shown;
+    uint16_t color = board_p->nativeBackground;
+    int i, j;
+
+    for (i = 0; i < board_p->width - 1 && x > layout->dotX[i + 1]; i++) ;
+    for (j = 0; j < board_p->height - 1 && y > layout->dotY[j + 1]; j++) ;
+    if (i < board_p->width - 1 && j < board_p->height - 1 &&
+        x >= layout->dotX[i] + 2 && x <= layout->dotX[i + 1] - 2 &&
+        y >= layout->dotY[j] + 2 && y <= layout->dotY[j + 1] - 2) {
+        int owner = shown->boxOwner[j * (board_p->width - 1) + i];
+        if (owner != BOARD_NO_OWNER) color = board_p->nativeColors[owner];
+    }
+
+    for (i = 0; i < board_p->width; i++) {
+        for (j = 0; j < board_p->height; j++) {
+            if (abs(x - layout->dotX[i]) + abs(y - layout->dotY[j]) <= 1) color = board_p->nativeForeground;
+        }
+    }
+
+    for (i = 0; i < board_p->numEdges; i++) {
+        const BoardEdge* line = &layout->edges[i];
+        if (shown->edgeOwner[i] != BOARD_NO_OWNER &&
+            x >= line->x1 && x <= line->x2 && y >= line->y1 && y <= line->y2) {
+            color = board_p->nativeColors[shown->edgeOwner[i]];
+        }
+    }
+
+    return color;
+}
+
+/**
+ * Capture function of the cursor sprite: rebuilds the pixels under it from
+ * the board as last drawn, so that the panel never has to be read back.
+ */
+static void Board_captureCursor(void* owner_p, int x0, int y0, int x1, int y1, uint16_t* pixels) {
+    Board* board_p = (Board*) owner_p;
+
+    int x, y; for (y = y0; y <= y1; y++) {
+        for (x = x0; x <= x1; x++) *pixels++ = Board_pixelColor(board_p, x, y);
+    }
+}
+
+void Board_start(Board* board_p, int width, int height, const uint32_t colors[BOARD_MAX_PLAYERS]) {
+    board_p->width    = width;
+    board_p->height   = height;
+    board_p->numEdges = width * (height - 1) + height * (width - 1);
+    board_p->numBoxes = (width - 1) * (height - 1);
+
+    int i;
+    for (i = 0; i < BOARD_MAX_PLAYERS; i++) {
+        board_p->colors[i] = colors[i];
+        board_p->scene.score[i] = 0;
+    }
+    for (i = 0; i < BOARD_MAX_EDGES; i++) board_p->scene.edgeOwner[i] = BOARD_NO_OWNER;
+    for (i = 0; i < BOARD_MAX_BOXES; i++) board_p->scene.boxOwner[i]  = BOARD_NO_OWNER;
+    board_p->scene.turn = 0;
+    board_p->scene.cursor = BOARD_NO_CURSOR;
+
+    board_p->cursor = GFX_constructSprite(BOARD_CURSOR_SIZE, BOARD_CURSOR_SIZE, cursorMask, BOARD_CURSOR_COLOR,
+                                          Board_captureCursor, board_p);
+
+    Board_buildLayout(board_p);
+    board_p->dirty = true;
+    Board_invalidate(board_p);
+}
+
+void Board_setEdge(Board* board_p, int edge, int player) {
+    if (edge >= 0 && edge < board_p->numEdges) board_p->scene.edgeOwner[edge] = player;
+    board_p->dirty = true;
+}
+
+void Board_setBox(Board* board_p, int box, int player) {
+    if (box >= 0 && box < board_p->numBoxes) board_p->scene.boxOwner[box] = player;
+    board_p->dirty = true;
+}
+
+void Board_setScore(Board* board_p, int player, int score) {
+    if (player >= 0 && player < BOARD_MAX_PLAYERS) board_p->scene.score[player] = score;
+    board_p->dirty = true;
+}
+
+void Board_setTurn(Board* board_p, int player) {
+    board_p->scene.turn = player;
+    board_p->dirty = true;
+}
+
+void Board_setCursor(Board* board_p, int edge) {
+    board_p->scene.cursor = (edge >= 0 && edge < board_p->numEdges) ? edge : BOARD_NO_CURSOR;
+    board_p->dirty = true;
+}
+
+int Board_nextFreeEdge(Board* board_p, int edge) {
+    int i; for (i = 1; i <= board_p->numEdges; i++) {
+        int next = (edge + i) % board_p->numEdges;
+        if (next < 0) next += board_p->numEdges;
+        if (board_p->scene.edgeOwner[next] == BOARD_NO_OWNER) return next;
+    }
+    return BOARD_NO_CURSOR;
+}
+
+void Board_invalidate(Board* board_p) {
+    board_p->repaint = true;
+}
+
+static void Board_drawEdge(Board* board_p, GFX* gfx_p, int edge) {
+    const BoardEdge* line = &board_p->layout.edges[edge];
+
+    GFX_setForeground(gfx_p, board_p->colors[board_p->scene.edgeOwner[edge]]);
+    if (line->y1 == line->y2) GFX_drawLineH(gfx_p, line->x1, line->x2, line->y1);
+    else                      GFX_drawLineV(gfx_p, line->x1, line->y1, line->y2);
+}
+
+/**
+ * Fills the inside of a box, two pixels in from its dots so that neither the
+ * dots nor the lines around it are touched.
+ */
+static void Board_drawBox(Board* board_p, GFX* gfx_p, int box) {
+    int i = box % (board_p->width - 1);
+    int j = box / (board_p->width - 1);
+
+    GFX_setForeground(gfx_p, board_p->colors[board_p->scene.boxOwner[box]]);
+    GFX_fillRect(gfx_p, board_p->layout.dotX[i] + 2, board_p->layout.dotY[j] + 2,
+                        board_p->layout.dotX[i + 1] - 2, board_p->layout.dotY[j + 1] - 2);
+}
+
+/**
+ * Writes each player's score into the text grid in their color, with a marker
+ * in front of the player whose turn it is. The grid only redraws the cells
+ * that changed.
+ */
+static void Board_drawScores(Board* board_p, GFX* gfx_p) {
+    char text[8];
+
+    int player; for (player = 0; player < BOARD_MAX_PLAYERS; player++) {
+        int col = player * (GFX_TEXT_COLS / BOARD_MAX_PLAYERS);
+
+        GFX_setForeground(gfx_p, FG_COLOR);
+        GFX_setText(gfx_p, (board_p->scene.turn == player) ? ">" : " ", BOARD_SCORE_ROW, col);
+
+        GFX_setForeground(gfx_p, board_p->colors[player]);
+        sprintf(text, "P%d:%2d", player + 1, board_p->scene.score[player]);
+        GFX_setText(gfx_p, text, BOARD_SCORE_ROW, col + 1);
+    }
+}
+
+/**
+ * Brings the panel up to date with the scene. After an invalidate the screen
+ * is cleared and everything that is owned gets drawn; otherwise only boxes,
+ * lines and scores which changed since the last render are. A line or box
+ * losing its owner cannot be drawn over cleanly, so it repaints the board.
+ */
+void Board_render(Board* board_p, GFX* gfx_p) {
+    BoardScene* scene = &board_p->scene;
+    BoardScene* shown = &board_p->shown;
+    uint32_t foreground = gfx_p->foreground;
+    int i;
+
+    if (!board_p->dirty && !board_p->repaint) return;
+    board_p->dirty = false;
+
+    for (i = 0; i < board_p->numEdges; i++) {
+        if (scene->edgeOwner[i] == BOARD_NO_OWNER && shown->edgeOwner[i] != BOARD_NO_OWNER) board_p->repaint = true;
+    }
+    for (i = 0; i < board_p->numBoxes; i++) {
+        if (scene->boxOwner[i] == BOARD_NO_OWNER && shown->boxOwner[i] != BOARD_NO_OWNER) board_p->repaint = true;
+    }
+
+    // Anything drawn under the cursor has to go in with the cursor lifted
+    bool boardChanged = board_p->repaint;
+    for (i = 0; i < board_p->numEdges; i++) {
+        if (scene->edgeOwner[i] != shown->edgeOwner[i]) boardChanged = true;
+    }
+    for (i = 0; i < board_p->numBoxes; i++) {
+        if (scene->boxOwner[i] != shown->boxOwner[i]) boardChanged = true;
+    }
+    bool cursorChanged = boardChanged || scene->cursor != shown->cursor;
+    if (cursorChanged && shown->cursor != BOARD_NO_CURSOR && !board_p->repaint) GFX_hideSprite(gfx_p, &board_p->cursor);
+
+    if (board_p->repaint) {
+        for (i = 0; i < BOARD_MAX_PLAYERS; i++) board_p->nativeColors[i] = GFX_nativeColor(gfx_p, board_p->colors[i]);
+        board_p->nativeForeground = GFX_nativeColor(gfx_p, FG_COLOR);
+        board_p->nativeBackground = GFX_nativeColor(gfx_p, gfx_p->background);
+
+        GFX_clear(gfx_p);
+        for (i = 0; i < BOARD_MAX_EDGES; i++) shown->edgeOwner[i] = BOARD_NO_OWNER;
+        for (i = 0; i < BOARD_MAX_BOXES; i++) shown->boxOwner[i]  = BOARD_NO_OWNER;
+    }
+
+    // Boxes go first, as they sit under nothing else
+    for (i = 0; i < board_p->numBoxes; i++) {
+        if (scene->boxOwner[i] != shown->boxOwner[i]) Board_drawBox(board_p, gfx_p, i);
+    }
+
+    if (board_p->repaint) {
+        GFX_setForeground(gfx_p, FG_COLOR);
+        GFX_drawDotGrid(gfx_p, board_p->layout.dotX, board_p->width, board_p->layout.dotY, board_p->height);
+    }
+
+    for (i = 0; i < board_p->numEdges; i++) {
+        if (scene->edgeOwner[i] != shown->edgeOwner[i]) Board_drawEdge(board_p, gfx_p, i);
+    }
+
+    bool scoresChanged = board_p->repaint || scene->turn != shown->turn;
+    for (i = 0; i < BOARD_MAX_PLAYERS; i++) {
+        if (scene->score[i] != shown->score[i]) scoresChanged = true;
+    }
+    if (scoresChanged) Board_drawScores(board_p, gfx_p);
+
+    *shown = *scene;
+    board_p->repaint = false;
+
+    if (cursorChanged && scene->cursor != BOARD_NO_CURSOR) {
+        const BoardEdge* line = &board_p->layout.edges[scene->cursor];
+        GFX_showSprite(gfx_p, &board_p->cursor, (line->x1 + line->x2) / 2 - BOARD_CURSOR_SIZE / 2,
+                                                (line->y1 + line->y2) / 2 - BOARD_CURSOR_SIZE / 2);
+    }
+
+    GFX_setForeground(gfx_p, foreground);
+}
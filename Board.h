@@ -0,0 +1,111 @@
+/*
+ * Board.h
+ *
+ *  The game board as a retained scene: which lines and boxes each player owns,
+ *  the scores and whose turn it is. The application only changes the scene;
+ *  Board_render() compares it with what was last drawn and sends just the
+ *  differences to the panel.
+ */
+
+#ifndef BOARD_H_
+#define BOARD_H_
+
+#include <HAL/Graphics.h>
+
+#define BOARD_MAX_DIM     5
+#define BOARD_MAX_EDGES   (2 * BOARD_MAX_DIM * (BOARD_MAX_DIM - 1))
+#define BOARD_MAX_BOXES   ((BOARD_MAX_DIM - 1) * (BOARD_MAX_DIM - 1))
+#define BOARD_MAX_PLAYERS 2
+
+// Owner of a line or box which nobody has taken yet
+#define BOARD_NO_OWNER (-1)
+
+// No edge is highlighted by the cursor
+#define BOARD_NO_CURSOR (-1)
+
+// The cursor is a square ring centered on the highlighted edge
+#define BOARD_CURSOR_SIZE 7
+#define BOARD_CURSOR_COLOR GRAPHICS_COLOR_YELLOW
+
+// Text row holding the score bar and turn indicator, below the largest board
+#define BOARD_SCORE_ROW 15
+
+// Screen endpoints of one line of the board
+struct _BoardEdge {
+    uint8_t x1, x2;
+    uint8_t y1, y2;
+};
+typedef struct _BoardEdge BoardEdge;
+
+// Pixel geometry of the board, built once when a game starts. Edges are
+// indexed like linesDrawn: each row of dots has its (width - 1) lines to the
+// right followed by its width lines down to the next row.
+struct _BoardLayout {
+    int dotX[BOARD_MAX_DIM];  // Screen x of each column of dots
+    int dotY[BOARD_MAX_DIM];  // Screen y of each row of dots
+    BoardEdge edges[BOARD_MAX_EDGES];
+};
+typedef struct _BoardLayout BoardLayout;
+
+// Everything shown on the game screen. Boxes are numbered row by row, like
+// boxesCompleted.
+struct _BoardScene {
+    int8_t edgeOwner[BOARD_MAX_EDGES];
+    int8_t boxOwner[BOARD_MAX_BOXES];
+    int score[BOARD_MAX_PLAYERS];
+    int turn;
+    int cursor;  // Highlighted edge, or BOARD_NO_CURSOR
+};
+typedef struct _BoardScene BoardScene;
+
+struct _Board {
+    int width;
+    int height;
+    int numEdges;
+    int numBoxes;
+    uint32_t colors[BOARD_MAX_PLAYERS];
+    BoardLayout layout;
+
+    // Native colors, for capturing the pixels under the cursor
+    uint16_t nativeColors[BOARD_MAX_PLAYERS];
+    uint16_t nativeForeground;
+    uint16_t nativeBackground;
+    GFXSprite cursor;
+
+    BoardScene scene;  // The board as the game wants it shown
+    BoardScene shown;  // The board as it was last drawn
+    bool repaint;      // The panel no longer matches shown
+    bool dirty;        // The scene changed since the last render
+};
+typedef struct _Board Board;
+
+// Pixel position of a dot on the game board, given the spacing between dots
+int Board_dotPixel(int spacing, int index);
+
+// Starts a new, empty board and lays it out for the given size. The first
+// Board_render() afterwards paints the whole screen.
+void Board_start(Board* board_p, int width, int height, const uint32_t colors[BOARD_MAX_PLAYERS]);
+
+// Scene changes. Nothing is drawn until Board_render(), so any number of them
+// between two renders cost one update of what they changed in the end. A box
+// is only filled in once the game gives it an owner with Board_setBox(); the
+// scene does not work out completed boxes from the edges by itself.
+void Board_setEdge(Board* board_p, int edge, int player);
+void Board_setBox(Board* board_p, int box, int player);
+void Board_setScore(Board* board_p, int player, int score);
+void Board_setTurn(Board* board_p, int player);
+void Board_setCursor(Board* board_p, int edge);
+
+// Returns the next edge after the given one that nobody owns yet, wrapping
+// around, or BOARD_NO_CURSOR when every edge is taken
+int Board_nextFreeEdge(Board* board_p, int edge);
+
+// Forgets what is on the panel, for when something else has drawn over the
+// board. The next Board_render() repaints the whole screen from the scene.
+void Board_invalidate(Board* board_p);
+
+// Draws whatever differs between the scene and the panel. Meant to be called
+// at the start of each GFX frame; it does nothing when the scene is unchanged.
+void Board_render(Board* board_p, GFX* gfx_p);
+
+#endif /* BOARD_H_ */
@@ -0,0 +1,276 @@
+/*
+ * Benchmark.c
+ *
+ *  Measures the throughput of the LCD driver primitives and the GFX calls
+ *  built on top of them.
+ */
+
+#include <HAL/Benchmark.h>
+
+#if GFX_BENCHMARK
+
+#include <HAL/LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h>
+#include <stdio.h>
+
+#define BENCH_TEXT_ROW "ABCDEFGHIJKLMNOPQRSTU"
+#define BENCH_TEXT_ROWS (LCD_VERTICAL_MAX / GLYPH_MAX_HEIGHT)
+
+// Storage for the display list of the full text screen, one bitmap per glyph
+static uint8_t benchListData[BENCH_TEXT_ROWS * GFX_TEXT_MAX * 16 + 16];
+static Crystalfontz128x128_DisplayList benchList = { benchListData, sizeof(benchListData), 0, false };
+
+// A full-screen image of 8-row stripes, one repeat run per row
+static const uint32_t benchImagePalette[] = { GRAPHICS_COLOR_BLACK, GRAPHICS_COLOR_WHITE };
+static uint8_t benchImageRuns[LCD_VERTICAL_MAX * 2];
+static const GFXImage benchImage = { 1, LCD_HORIZONTAL_MAX, LCD_VERTICAL_MAX, benchImagePalette, benchImageRuns };
+
+// Dot positions of the largest game board, one sixth of the screen apart
+#define BENCH_BOARD_DIM 6
+static int benchBoardDots[BENCH_BOARD_DIM];
+
+/**
+ * The operation being measured. Each benchmark calls it a number of times and
+ * waits for the panel to finish, so DMA transfers still in flight are counted.
+ */
+typedef void (*BenchFunction)(GFX* gfx_p, int call);
+
+static void Benchmark_report(UART* uart_p, const char* name, int calls, uint64_t totalUS, uint32_t pixelsPerCall)
+{
+    char line[96];
+    uint64_t pixels = (uint64_t) pixelsPerCall * calls;
+    uint64_t bytes = LCD_PIXEL_BYTES(pixelsPerCall) * (uint64_t) calls;
+
+    if (totalUS == 0) totalUS = 1;
+
+    sprintf(line, "bench,%s,%d,%lu,%lu,%lu,%lu\r\n", name, calls,
+            (unsigned long) totalUS,
+            (unsigned long) (totalUS / calls),
+            (unsigned long) (pixels * US_DIVISION_FACTOR / totalUS),
+            (unsigned long) (bytes * US_DIVISION_FACTOR / totalUS));
+    UART_sendString(uart_p, line);
+}
+
+static void Benchmark_measure(HAL* hal_p, const char* name, BenchFunction function, int calls, uint32_t pixelsPerCall)
+{
+    // Nothing from the previous benchmark may still be on its way to the panel,
+    // and its report may not still be going out while this one is timed
+    GFX_flush(&hal_p->gfx);
+    UART_flush(&hal_p->uart);
+
+    SWTimer timer = SWTimer_construct(0);
+    SWTimer_start(&timer);
+
+    int i; for (i = 0; i < calls; i++) {
+        function(&hal_p->gfx, i);
+    }
+    GFX_flush(&hal_p->gfx);
+
+    Benchmark_report(&hal_p->uart, name, calls, SWTimer_elapsedTimeUS(&timer), pixelsPerCall);
+}
+
+// Colors alternate between calls so that the shadow buffer, if enabled, always
+// has something to push
+static uint16_t Benchmark_color(GFX* gfx_p, int call)
+{
+    return g_sCrystalfontz128x128_funcs.pfnColorTranslate(gfx_p->context.display,
+                                                         (call & 1) ? GRAPHICS_COLOR_WHITE : GRAPHICS_COLOR_BLUE);
+}
+
+static void Bench_pixelDraw(GFX* gfx_p, int call)
+{
+    g_sCrystalfontz128x128_funcs.pfnPixelDraw(gfx_p->context.display, call % LCD_HORIZONTAL_MAX, 64, Benchmark_color(gfx_p, call));
+}
+
+static void Bench_pixelDrawMultiple(GFX* gfx_p, int call)
+{
+    static const uint8_t row[LCD_HORIZONTAL_MAX / 8] = { 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55,
+                                                         0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55 };
+    uint32_t palette[2] = { Benchmark_color(gfx_p, call), Benchmark_color(gfx_p, call + 1) };
+
+    g_sCrystalfontz128x128_funcs.pfnPixelDrawMultiple(gfx_p->context.display, 0, call % LCD_VERTICAL_MAX, 0,
+                                                      LCD_HORIZONTAL_MAX, 1, row, palette);
+}
+
+// A saved 16x16 block put back from memory, as done for sprites and save-unders
+static void Bench_streamPixels(GFX* gfx_p, int call)
+{
+    static uint16_t block[16 * 16];
+    int x = (call % 8) * 16;
+    int y = (call / 8 % 8) * 16;
+
+    if (call == 0) {
+        int i; for (i = 0; i < 16 * 16; i++) block[i] = Benchmark_color(gfx_p, i);
+    }
+
+    Crystalfontz128x128_BeginStream(x, y, x + 15, y + 15);
+    Crystalfontz128x128_StreamPixels(block, 16 * 16);
+    Crystalfontz128x128_EndStream();
+}
+
+static void Bench_lineDrawH(GFX* gfx_p, int call)
+{
+    g_sCrystalfontz128x128_funcs.pfnLineDrawH(gfx_p->context.display, 0, LCD_HORIZONTAL_MAX - 1,
+                                              call % LCD_VERTICAL_MAX, Benchmark_color(gfx_p, call));
+}
+
+static void Bench_lineDrawV(GFX* gfx_p, int call)
+{
+    g_sCrystalfontz128x128_funcs.pfnLineDrawV(gfx_p->context.display, call % LCD_HORIZONTAL_MAX, 0,
+                                              LCD_VERTICAL_MAX - 1, Benchmark_color(gfx_p, call));
+}
+
+static void Bench_rectFill(GFX* gfx_p, int call)
+{
+    Graphics_Rectangle rect = { 0, 0, LCD_HORIZONTAL_MAX - 1, LCD_VERTICAL_MAX - 1 };
+    g_sCrystalfontz128x128_funcs.pfnRectFill(gfx_p->context.display, &rect, Benchmark_color(gfx_p, call));
+}
+
+static void Bench_colorTranslate(GFX* gfx_p, int call)
+{
+    Benchmark_color(gfx_p, call);
+}
+
+static void Bench_flush(GFX* gfx_p, int call)
+{
+    g_sCrystalfontz128x128_funcs.pfnFlush(gfx_p->context.display);
+}
+
+static void Bench_clearDisplay(GFX* gfx_p, int call)
+{
+    g_sCrystalfontz128x128_funcs.pfnClearDisplay(gfx_p->context.display, Benchmark_color(gfx_p, call));
+}
+
+static void Bench_gfxClear(GFX* gfx_p, int call)
+{
+    GFX_clear(gfx_p);
+}
+
+static void Bench_gfxGlyph(GFX* gfx_p, int call)
+{
+    char glyph[2] = { 'A' + call % 26, '\0' };
+    GFX_print(gfx_p, glyph, GFX_FIXED_INT(call % BENCH_TEXT_ROWS), GFX_FIXED_INT(call % GFX_TEXT_MAX));
+}
+
+static void Bench_gfxTextRow(GFX* gfx_p, int call)
+{
+    GFX_print(gfx_p, BENCH_TEXT_ROW, GFX_FIXED_INT(call % BENCH_TEXT_ROWS), 0);
+}
+
+static void Bench_gfxEraseText(GFX* gfx_p, int call)
+{
+    GFX_eraseText(gfx_p, BENCH_TEXT_ROW, GFX_FIXED_INT(call % BENCH_TEXT_ROWS), 0);
+}
+
+static void Bench_gfxLineH(GFX* gfx_p, int call)
+{
+    int y = call % LCD_VERTICAL_MAX;
+    GFX_drawLineH(gfx_p, 0, LCD_HORIZONTAL_MAX - 1, y);
+}
+
+static void Bench_gfxLineDiagonal(GFX* gfx_p, int call)
+{
+    GFX_drawLine(gfx_p, 0, LCD_HORIZONTAL_MAX - 1, 0, LCD_VERTICAL_MAX - 1);
+}
+
+// Radius-1 dots, as drawn for the board by Application_showGameScreen()
+static void Bench_gfxSolidCircle(GFX* gfx_p, int call)
+{
+    GFX_drawSolidCircle(gfx_p, 4 + (call % 30) * 4, 4 + (call / 30 % 30) * 4, 1);
+}
+
+// The same dots as the board, a whole grid at a time
+static void Bench_gfxDotGrid(GFX* gfx_p, int call)
+{
+    GFX_drawDotGrid(gfx_p, benchBoardDots, BENCH_BOARD_DIM, benchBoardDots, BENCH_BOARD_DIM);
+}
+
+static void Bench_gfxHollowCircle(GFX* gfx_p, int call)
+{
+    GFX_drawHollowCircle(gfx_p, 4 + (call % 30) * 4, 4 + (call / 30 % 30) * 4, 1);
+}
+
+static void Bench_gfxImage(GFX* gfx_p, int call)
+{
+    GFX_drawImage(gfx_p, &benchImage, 0, 0);
+}
+
+static void Bench_screenText(GFX* gfx_p, int call)
+{
+    GFX_clear(gfx_p);
+    int row; for (row = 0; row < BENCH_TEXT_ROWS; row++) {
+        GFX_print(gfx_p, BENCH_TEXT_ROW, GFX_FIXED_INT(row), 0);
+    }
+}
+
+static void Bench_screenTextReplay(GFX* gfx_p, int call)
+{
+    GFX_replay(gfx_p, &benchList);
+}
+
+// The board of the largest game: a grid of dots with every line drawn
+static void Bench_screenGame(GFX* gfx_p, int call)
+{
+    const int first = benchBoardDots[0];
+    const int last = benchBoardDots[BENCH_BOARD_DIM - 1];
+    int i;
+
+    GFX_clear(gfx_p);
+    GFX_drawDotGrid(gfx_p, benchBoardDots, BENCH_BOARD_DIM, benchBoardDots, BENCH_BOARD_DIM);
+    for (i = 0; i < BENCH_BOARD_DIM; i++) {
+        GFX_drawLineH(gfx_p, first, last, benchBoardDots[i]);
+        GFX_drawLineV(gfx_p, benchBoardDots[i], first, last);
+    }
+}
+
+void Benchmark_run(HAL* hal_p)
+{
+    const uint32_t screen = LCD_HORIZONTAL_MAX * LCD_VERTICAL_MAX;
+    const uint32_t glyph = GLYPH_MAX_WIDTH * GLYPH_MAX_HEIGHT;
+    int i;
+
+    for (i = 0; i < LCD_VERTICAL_MAX; i++) {
+        benchImageRuns[2 * i] = LCD_HORIZONTAL_MAX - 1;
+        benchImageRuns[2 * i + 1] = (i / 8) & 1;
+    }
+    for (i = 0; i < BENCH_BOARD_DIM; i++) {
+        benchBoardDots[i] = LCD_HORIZONTAL_MAX / BENCH_BOARD_DIM * i + LCD_HORIZONTAL_MAX / BENCH_BOARD_DIM / 2;
+    }
+
+    UART_sendString(&hal_p->uart, "bench,begin,calls,total_us,us_per_call,pixels_per_s,bytes_per_s\r\n");
+
+    Benchmark_measure(hal_p, "lcd_pixel_draw", Bench_pixelDraw, 1000, 1);
+    Benchmark_measure(hal_p, "lcd_pixel_draw_multiple_128", Bench_pixelDrawMultiple, 256, LCD_HORIZONTAL_MAX);
+    Benchmark_measure(hal_p, "lcd_stream_pixels_16x16", Bench_streamPixels, 256, 16 * 16);
+    Benchmark_measure(hal_p, "lcd_line_h_128", Bench_lineDrawH, 256, LCD_HORIZONTAL_MAX);
+    Benchmark_measure(hal_p, "lcd_line_v_128", Bench_lineDrawV, 256, LCD_VERTICAL_MAX);
+    Benchmark_measure(hal_p, "lcd_rect_fill_full", Bench_rectFill, 16, screen);
+    Benchmark_measure(hal_p, "lcd_color_translate", Bench_colorTranslate, 1000, 0);
+    Benchmark_measure(hal_p, "lcd_flush", Bench_flush, 1000, 0);
+    Benchmark_measure(hal_p, "lcd_clear_display", Bench_clearDisplay, 16, screen);
+
+    Benchmark_measure(hal_p, "gfx_clear", Bench_gfxClear, 16, screen);
+    Benchmark_measure(hal_p, "gfx_print_glyph", Bench_gfxGlyph, 500, glyph);
+    Benchmark_measure(hal_p, "gfx_print_row_21", Bench_gfxTextRow, 64, glyph * GFX_TEXT_MAX);
+    Benchmark_measure(hal_p, "gfx_erase_text_21", Bench_gfxEraseText, 64, glyph * GFX_TEXT_MAX);
+    Benchmark_measure(hal_p, "gfx_line_h_128", Bench_gfxLineH, 256, LCD_HORIZONTAL_MAX);
+    Benchmark_measure(hal_p, "gfx_line_diagonal_128", Bench_gfxLineDiagonal, 64, LCD_HORIZONTAL_MAX);
+    // A radius-1 circle covers the 3x3 square around its center, less corners
+    Benchmark_measure(hal_p, "gfx_solid_circle_r1", Bench_gfxSolidCircle, 900, 5);
+    Benchmark_measure(hal_p, "gfx_dot_grid_6x6", Bench_gfxDotGrid, 64, 5 * BENCH_BOARD_DIM * BENCH_BOARD_DIM);
+    Benchmark_measure(hal_p, "gfx_hollow_circle_r1", Bench_gfxHollowCircle, 900, 4);
+    Benchmark_measure(hal_p, "gfx_image_full", Bench_gfxImage, 16, screen);
+
+    Benchmark_measure(hal_p, "screen_text", Bench_screenText, 8, screen);
+    GFX_startRecording(&hal_p->gfx, &benchList);
+    Bench_screenText(&hal_p->gfx, 0);
+    GFX_stopRecording(&hal_p->gfx);
+    Benchmark_measure(hal_p, "screen_text_replay", Bench_screenTextReplay, 8, screen);
+    Benchmark_measure(hal_p, "screen_game", Bench_screenGame, 8, screen);
+
+    UART_sendString(&hal_p->uart, "bench,end\r\n");
+
+    GFX_clear(&hal_p->gfx);
+    GFX_flush(&hal_p->gfx);
+}
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ * Benchmark.h
+ *
+ *  Measures the throughput of the LCD driver primitives and the GFX calls
+ *  built on top of them.
+ */
+
+#ifndef HAL_BENCHMARK_H_
+#define HAL_BENCHMARK_H_
+
+#include <HAL/HAL.h>
+
+// Set to 1 to run the benchmark suite once the HAL is constructed, before the
+// application starts. Results are sent over the UART as CSV lines:
+//   bench,<name>,<calls>,<total us>,<us per call>,<pixels/s>,<bytes/s>
+// framed by a "bench,begin,..." header and a "bench,end" line. Bytes are the
+// pixel data sent to the panel in the configured interface pixel format.
+#define GFX_BENCHMARK 0
+
+// Runs every benchmark and reports the results; the screen is left cleared.
+void Benchmark_run(HAL* hal_p);
+
+#endif /* HAL_BENCHMARK_H_ */
@@ -0,0 +1,108 @@
+/*
+ * Dma.c
+ *
+ *  Shares the one uDMA channel that the LCD and the USB UART can both use.
+ */
+
+#include <HAL/Dma.h>
+
+// The uDMA control table must be aligned to a 1024-byte boundary
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(dmaControlTable, 1024)
+static DMA_ControlTable dmaControlTable[64];
+#elif defined(__IAR_SYSTEMS_ICC__)
+#pragma data_alignment = 1024
+static DMA_ControlTable dmaControlTable[64];
+#else
+static DMA_ControlTable dmaControlTable[64] __attribute__((aligned(1024)));
+#endif
+
+static bool dmaInitialized = false;
+
+/** The completion handler of the module which owns the channel, or NULL while
+ * the channel is free. */
+static volatile DmaHandler dmaOwner = NULL;
+
+/** The completion handler of the last module turned away from the channel, or
+ * NULL once that has been seen through Dma_isWanted() */
+static volatile DmaHandler dmaWaiting = NULL;
+
+/**
+ * The completion interrupt of the shared channel, passed on to its owner. DO
+ * NOT DIRECTLY INVOKE THIS FUNCTION FROM YOUR CODE.
+ */
+void DMA_INT1_IRQHandler(void) {
+  DMA_clearInterruptFlag(DMA_SHARED_CHANNEL);
+
+  if (dmaOwner != NULL) dmaOwner();
+}
+
+/**
+ * Enables the controller and routes the completion of the shared channel to
+ * DMA_INT1. Requests from the channel's peripheral are let through only while
+ * a transfer is armed, since the channel disables itself at the end of one.
+ */
+void Dma_init(void) {
+  if (dmaInitialized) return;
+  dmaInitialized = true;
+
+  DMA_enableModule();
+  DMA_setControlBase(dmaControlTable);
+
+  DMA_disableChannelAttribute(DMA_SHARED_CHANNEL,
+                              UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST |
+                                  UDMA_ATTR_HIGH_PRIORITY | UDMA_ATTR_REQMASK);
+
+  DMA_assignInterrupt(DMA_SHARED_INTERRUPT, DMA_SHARED_CHANNEL);
+  DMA_clearInterruptFlag(DMA_SHARED_CHANNEL);
+  DMA_enableInterrupt(DMA_SHARED_INTERRUPT_NUMBER);
+}
+
+/**
+ * Checks and claims the channel with interrupts held off, since the UART
+ * claims it from its ISR while the LCD claims it from the main loop. The
+ * channel's trigger is switched over to the new owner's peripheral.
+ */
+bool Dma_acquire(uint32_t mapping, DmaHandler done) {
+  bool wasDisabled = Interrupt_disableMaster();
+  bool acquired = dmaOwner == NULL;
+
+  if (acquired) {
+    dmaOwner = done;
+    DMA_assignChannel(mapping);
+    if (dmaWaiting == done) dmaWaiting = NULL;
+  } else
+    dmaWaiting = done;
+
+  if (!wasDisabled) Interrupt_enableMaster();
+  return acquired;
+}
+
+void Dma_release(void) {
+  dmaOwner = NULL;
+}
+
+bool Dma_isWanted(DmaHandler done) {
+  bool wasDisabled = Interrupt_disableMaster();
+  bool wanted = dmaWaiting != NULL && dmaWaiting != done;
+
+  if (wanted) dmaWaiting = NULL;
+
+  if (!wasDisabled) Interrupt_enableMaster();
+  return wanted;
+}
+
+/**
+ * Sets up a basic-mode transfer of bytes to a fixed destination and enables
+ * the channel. The transfer starts with the next request from the owner's
+ * peripheral.
+ */
+void Dma_start(const void* source, volatile void* dest, uint32_t count,
+               uint32_t sourceIncrement) {
+  DMA_setChannelControl(UDMA_PRI_SELECT | DMA_SHARED_CHANNEL,
+                        UDMA_SIZE_8 | sourceIncrement | UDMA_DST_INC_NONE |
+                            UDMA_ARB_1);
+  DMA_setChannelTransfer(UDMA_PRI_SELECT | DMA_SHARED_CHANNEL, UDMA_MODE_BASIC,
+                         (void*)source, (void*)dest, count);
+  DMA_enableChannel(DMA_SHARED_CHANNEL);
+}
@@ -0,0 +1,56 @@
+/*
+ * Dma.h
+ *
+ *  Shares the one uDMA channel that the LCD and the USB UART can both use.
+ *  EUSCI_B0 TX (the LCD's SPI) and EUSCI_A0 TX (the USB UART) are only wired to
+ *  uDMA channel 0, so the two take turns: whichever finds the channel free
+ *  claims it for one transfer and hands it back when the transfer completes.
+ *  A module that finds the channel taken sends by CPU instead of waiting, and
+ *  is remembered so that a module sending a long run of transfers can step
+ *  aside for it.
+ */
+
+#ifndef HAL_DMA_H_
+#define HAL_DMA_H_
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+// The shared channel and the interrupt raised when a transfer on it completes
+#define DMA_SHARED_CHANNEL DMA_CHANNEL_0
+#define DMA_SHARED_INTERRUPT DMA_INT1
+#define DMA_SHARED_INTERRUPT_NUMBER INT_DMA_INT1
+
+// Largest number of transfers the uDMA can perform in one basic-mode cycle
+#define DMA_MAX_TRANSFERS 1024
+
+// Called from the DMA interrupt when the owner's transfer has completed. The
+// channel is still owned; the handler either starts the next transfer or
+// releases it.
+typedef void (*DmaHandler)(void);
+
+// Sets up the uDMA controller and the shared channel. Safe to call more than
+// once, by each module that uses the channel.
+void Dma_init(void);
+
+// Claims the shared channel for a transfer triggered by the given peripheral
+// (one of the DMA_CHx_ mappings for channel 0). Returns false, and changes
+// nothing, if another module is using it. May be called from an ISR.
+bool Dma_acquire(uint32_t mapping, DmaHandler done);
+
+// Gives the channel back once the owner's last transfer has completed
+void Dma_release(void);
+
+// Returns true, once, if a module other than the one completing through done
+// has been turned away by Dma_acquire() since the last call. That module has
+// already fallen back to the CPU, so the caller should leave the channel free
+// for a while to let its next transfer through.
+bool Dma_isWanted(DmaHandler done);
+
+// Arms the shared channel to move count bytes from source to the peripheral
+// register dest, one byte per trigger. sourceIncrement is UDMA_SRC_INC_8 to
+// walk through a buffer, or UDMA_SRC_INC_NONE to send one byte over and over.
+// Only the owner may call this.
+void Dma_start(const void* source, volatile void* dest, uint32_t count,
+               uint32_t sourceIncrement);
+
+#endif /* HAL_DMA_H_ */
@@ -7,6 +7,704 @@
 
 #include <HAL/Graphics.h>
 
+#include <string.h>
+
+/**
+ * The glyph cache. Each printable character is expanded on first use into a
+ * block of pixels in the panel's interface format for the color pair it was
+ * drawn with. A cached glyph is then sent to the LCD in a
+ * single draw window instead of one window and one palette lookup per pixel.
+ * There is only one GFX object in the project, so the cache is kept here
+ * rather than copied around inside the GFX struct.
+ */
+static uint8_t glyphCache[GLYPH_NUM_CHARS][GLYPH_MAX_WIDTH * GLYPH_MAX_HEIGHT * 2];
+static uint8_t glyphWidths[GLYPH_NUM_CHARS];
+static uint32_t glyphValid[(GLYPH_NUM_CHARS + 31) / 32];
+static uint32_t glyphForeground;
+static uint32_t glyphBackground;
+
+/**
+ * The render queue, a ring of draw calls waiting to reach the panel. Like the
+ * glyph cache it belongs to the single GFX object but is kept out of the
+ * struct, which is returned by value from GFX_construct().
+ */
+static GFXCommand renderQueue[GFX_QUEUE_SIZE];
+static unsigned int renderHead;
+static unsigned int renderCount;
+
+// How many of the queued calls, from the head, belong to the frame being
+// rendered. Calls queued after the frame started wait for the next one.
+static unsigned int frameCount;
+
+/**
+ * The text grid, as written by the application and as last drawn on the
+ * panel. A flush of the grid is queued like any other draw call when a write
+ * changes a cell, unless one is already queued behind every other call.
+ */
+static GFXTextCell textCells[GFX_TEXT_ROWS][GFX_TEXT_COLS];
+static GFXTextCell textShown[GFX_TEXT_ROWS][GFX_TEXT_COLS];
+static bool textFlushQueued;
+
+/**
+ * Draw calls are numbered in queue order, each keeping its number in the
+ * queue; queuedCalls counts those queued so far. Each cell records the number
+ * of calls queued before it was last written. A call other than a grid flush that
+ * draws over cells marks them GFX_TEXT_COVERED in textShown, with its own
+ * number: the panel no longer shows what textShown claims there, but the
+ * cells are only redrawn if they were written after that call was queued, so
+ * that older text does not paint over a pop-up.
+ */
+#define GFX_TEXT_COVERED '\0'
+
+static uint32_t textWritten[GFX_TEXT_ROWS][GFX_TEXT_COLS];
+static uint32_t textCoveredBy[GFX_TEXT_ROWS][GFX_TEXT_COLS];
+static uint32_t queuedCalls;
+
+/**
+ * Counts the screens drawn from scratch, by a clear or a display list replay.
+ * A sprite shown on an earlier screen has been painted over, so its backing
+ * store is stale and must not be put back.
+ */
+static uint16_t screenNumber;
+
+static void GFX_invalidateGlyphs()
+{
+    int i; for (i = 0; i < (GLYPH_NUM_CHARS + 31) / 32; i++) {
+        glyphValid[i] = 0;
+    }
+}
+
+/**
+ * Returns the bitmap of a character in the current font, stored as one row
+ * after another, each row padded to a whole byte, MSB leftmost. Returns NULL
+ * when the character has no bitmap that fits a 6x8 cell (outside the
+ * printable range, a compressed font, or a larger glyph).
+ */
+static const uint8_t* GFX_getGlyphBitmap(GFX* gfx_p, char c, int* width_p)
+{
+    const Graphics_Font* font = gfx_p->context.font;
+
+    if (c < GLYPH_FIRST_CHAR || c > GLYPH_LAST_CHAR) return NULL;
+    if (font->format != FONT_FMT_UNCOMPRESSED) return NULL;
+    if (font->height > GLYPH_MAX_HEIGHT) return NULL;
+
+    // Uncompressed glyphs are stored as [size][width] followed by the bitmap
+    const uint8_t* data = font->data + font->offset[c - GLYPH_FIRST_CHAR];
+    if (data[1] > GLYPH_MAX_WIDTH) return NULL;
+
+    *width_p = data[1];
+    return data + 2;
+}
+
+/**
+ * Returns the cached glyph for a character, expanding it first if needed.
+ * Returns NULL when the character cannot be cached, in which case the caller
+ * falls back to grlib.
+ */
+static const uint8_t* GFX_getGlyph(GFX* gfx_p, char c, int* width_p)
+{
+    const Graphics_Font* font = gfx_p->context.font;
+
+    int width;
+    const uint8_t* bitmap = GFX_getGlyphBitmap(gfx_p, c, &width);
+    if (bitmap == NULL) return NULL;
+
+    // A change of colors that bypassed GFX_setForeground/Background still
+    // invalidates the cache
+    if (glyphForeground != gfx_p->context.foreground || glyphBackground != gfx_p->context.background) {
+        GFX_invalidateGlyphs();
+        glyphForeground = gfx_p->context.foreground;
+        glyphBackground = gfx_p->context.background;
+    }
+
+    int index = c - GLYPH_FIRST_CHAR;
+    uint8_t* pixels = glyphCache[index];
+
+    if (glyphValid[index / 32] & (1u << (index % 32))) {
+        *width_p = glyphWidths[index];
+        return pixels;
+    }
+
+    int bytesPerRow = (width + 7) / 8;
+
+    // The previous contents of this entry may still be streaming to the LCD
+    Crystalfontz128x128_WaitForCompletion();
+
+    int i = 0;
+    int x, y; for (y = 0; y < font->height; y++) {
+        const uint8_t* row = bitmap + y * bytesPerRow;
+        for (x = 0; x < width; x++) {
+            uint32_t color = (row[x / 8] & (0x80 >> (x % 8))) ? glyphForeground : glyphBackground;
+            Crystalfontz128x128_PackPixel(pixels, i++, color);
+        }
+    }
+
+    glyphWidths[index] = width;
+    glyphValid[index / 32] |= 1u << (index % 32);
+
+    *width_p = width;
+    return glyphCache[index];
+}
+
+/**
+ * Draws a string with its top-left corner at the given pixel position. Glyphs
+ * which fit on the screen come from the glyph cache; anything else is left to
+ * grlib so clipping and unsupported characters behave as before.
+ */
+static void GFX_drawString(GFX* gfx_p, char* string, int x, int y)
+{
+    int height = Graphics_getFontHeight(gfx_p->context.font);
+
+    for (; *string; string++) {
+        int width;
+        const uint8_t* glyph = GFX_getGlyph(gfx_p, *string, &width);
+
+        if (glyph != NULL && x >= 0 && y >= 0 &&
+            x + width <= LCD_HORIZONTAL_MAX && y + height <= LCD_VERTICAL_MAX) {
+            Crystalfontz128x128_DrawNativeRect(x, y, x + width - 1, y + height - 1, glyph);
+        }
+        else {
+            Graphics_drawString(&gfx_p->context, (int8_t*) string, 1, x, y, OPAQUE_TEXT);
+            width = Graphics_getFontMaxWidth(gfx_p->context.font);
+        }
+
+        x += width;
+    }
+}
+
+static void GFX_blankTextCells(GFXTextCell cells[][GFX_TEXT_COLS], uint16_t background)
+{
+    int row, col; for (row = 0; row < GFX_TEXT_ROWS; row++) {
+        for (col = 0; col < GFX_TEXT_COLS; col++) {
+            cells[row][col].c = ' ';
+            cells[row][col].foreground = background;
+            cells[row][col].background = background;
+        }
+    }
+}
+
+static bool GFX_sameTextCell(const GFXTextCell* a, const GFXTextCell* b)
+{
+    // Blank cells look the same whatever their foreground
+    if (a->c == ' ' && b->c == ' ') return a->background == b->background;
+    return a->c == b->c && a->foreground == b->foreground && a->background == b->background;
+}
+
+// Whether a grid flush has to redraw a cell
+static bool GFX_textCellStale(int row, int col)
+{
+    if (textShown[row][col].c == GFX_TEXT_COVERED && textWritten[row][col] <= textCoveredBy[row][col]) return false;
+    return !GFX_sameTextCell(&textCells[row][col], &textShown[row][col]);
+}
+
+/**
+ * Marks the text grid cells under the pixel rectangle with corners (x0, y0)
+ * and (x1, y1) as covered by draw call number call.
+ */
+static void GFX_coverText(int x0, int y0, int x1, int y1, uint32_t call)
+{
+    int swap;
+    if (x0 > x1) { swap = x0; x0 = x1; x1 = swap; }
+    if (y0 > y1) { swap = y0; y0 = y1; y1 = swap; }
+    if (x1 < 0 || y1 < 0) return;
+
+    int firstCol = x0 < 0 ? 0 : x0 / GLYPH_MAX_WIDTH;
+    int lastCol = x1 / GLYPH_MAX_WIDTH;
+    int firstRow = y0 < 0 ? 0 : y0 / GLYPH_MAX_HEIGHT;
+    int lastRow = y1 / GLYPH_MAX_HEIGHT;
+
+    if (lastCol >= GFX_TEXT_COLS) lastCol = GFX_TEXT_COLS - 1;
+    if (lastRow >= GFX_TEXT_ROWS) lastRow = GFX_TEXT_ROWS - 1;
+
+    int row; for (row = firstRow; row <= lastRow; row++) {
+        int col; for (col = firstCol; col <= lastCol; col++) {
+            textShown[row][col].c = GFX_TEXT_COVERED;
+            textCoveredBy[row][col] = call;
+        }
+    }
+}
+
+/**
+ * Covers cells for a draw made straight to the LCD, outside the queue. It
+ * takes the next call number, so it counts as queued after every write so far.
+ */
+static void GFX_coverTextNow(int x0, int y0, int x1, int y1)
+{
+    GFX_coverText(x0, y0, x1, y1, queuedCalls++);
+}
+
+/**
+ * Draws text grid cells [first, last] of a row through a single draw window.
+ * The glyphs are read straight from the font, one pixel row of the whole run
+ * at a time, and sent as runs of one color.
+ */
+static void GFX_drawTextCells(GFX* gfx_p, int row, int first, int last)
+{
+    uint16_t runColor = 0;
+    uint32_t runLength = 0;
+
+    Crystalfontz128x128_BeginStream(first * GLYPH_MAX_WIDTH, row * GLYPH_MAX_HEIGHT,
+                                    (last + 1) * GLYPH_MAX_WIDTH - 1, (row + 1) * GLYPH_MAX_HEIGHT - 1);
+
+    int y; for (y = 0; y < GLYPH_MAX_HEIGHT; y++) {
+        int col; for (col = first; col <= last; col++) {
+            const GFXTextCell* cell = &textCells[row][col];
+            int width = 0;
+            const uint8_t* bits = GFX_getGlyphBitmap(gfx_p, cell->c, &width);
+
+            if (bits != NULL && y < gfx_p->context.font->height) bits += y * ((width + 7) / 8);
+            else width = 0;
+
+            int x; for (x = 0; x < GLYPH_MAX_WIDTH; x++) {
+                bool set = x < width && (bits[x / 8] & (0x80 >> (x % 8)));
+                uint16_t color = set ? cell->foreground : cell->background;
+
+                if (runLength > 0 && color != runColor) {
+                    Crystalfontz128x128_StreamRun(runColor, runLength);
+                    runLength = 0;
+                }
+                runColor = color;
+                runLength++;
+            }
+        }
+    }
+
+    Crystalfontz128x128_StreamRun(runColor, runLength);
+    Crystalfontz128x128_EndStream();
+}
+
+/**
+ * Redraws every horizontal run of text grid cells which differ from what was
+ * last drawn.
+ */
+static void GFX_drawTextGrid(GFX* gfx_p)
+{
+    textFlushQueued = false;
+
+    int row; for (row = 0; row < GFX_TEXT_ROWS; row++) {
+        int col = 0;
+        while (col < GFX_TEXT_COLS) {
+            if (!GFX_textCellStale(row, col)) {
+                col++;
+                continue;
+            }
+
+            int first = col;
+            while (col < GFX_TEXT_COLS && GFX_textCellStale(row, col)) {
+                textShown[row][col] = textCells[row][col];
+                col++;
+            }
+            GFX_drawTextCells(gfx_p, row, first, col - 1);
+        }
+    }
+}
+
+/**
+ * Decodes an image straight into an LCD draw window, one run at a time, so
+ * no decompressed copy is ever held in memory. Consecutive runs of the same
+ * palette entry are joined, which lets a long stretch of background go out
+ * as a single fill.
+ */
+static void GFX_decodeImage(GFX* gfx_p, const GFXImage* image, int x, int y)
+{
+    const Graphics_Display* display = gfx_p->context.display;
+    const uint8_t* runs = image->runs;
+    uint32_t remaining = (uint32_t) image->width * image->height;
+
+    Crystalfontz128x128_BeginStream(x, y, x + image->width - 1, y + image->height - 1);
+
+    while (remaining > 0) {
+        uint8_t header = *runs++;
+        uint32_t count = (header & 0x7F) + 1;
+        if (count > remaining) count = remaining;
+
+        if (header & 0x80) {
+            uint32_t bit; for (bit = 0; bit < count * image->bpp; bit += image->bpp) {
+                uint8_t index = (runs[bit / 8] >> (8 - image->bpp - bit % 8)) & ((1 << image->bpp) - 1);
+                Crystalfontz128x128_StreamRun(g_sCrystalfontz128x128_funcs.pfnColorTranslate(display, image->palette[index]), 1);
+            }
+            runs += (count * image->bpp + 7) / 8;
+        }
+        else {
+            uint8_t index = *runs++;
+            while (count < remaining && !(runs[0] & 0x80) && runs[1] == index) {
+                count += (runs[0] & 0x7F) + 1;
+                runs += 2;
+            }
+            if (count > remaining) count = remaining;
+            Crystalfontz128x128_StreamRun(g_sCrystalfontz128x128_funcs.pfnColorTranslate(display, image->palette[index]), count);
+        }
+
+        remaining -= count;
+    }
+
+    Crystalfontz128x128_EndStream();
+}
+
+/**
+ * The board dot: the pixels Graphics_fillCircle() sets for a radius of 1, one
+ * row per byte, with the left column in bit 2.
+ */
+static const uint8_t dotSprite[GFX_DOT_SIZE] = { 0x2, 0x7, 0x2 };
+
+/**
+ * Paints one row of dots as a single draw window, GFX_DOT_SIZE pixels tall and
+ * reaching from the first dot to the last. The sprite rows are joined with
+ * the background between the dots into runs, so the whole strip is a few
+ * stream runs instead of a draw window per line of every dot.
+ */
+static void GFX_drawDotRow(GFX* gfx_p, const int* dotX, int numX, int y)
+{
+    uint16_t foreground = gfx_p->context.foreground;
+    uint16_t background = gfx_p->context.background;
+    int x0 = dotX[0] - GFX_DOT_SIZE / 2;
+    int x1 = dotX[numX - 1] + GFX_DOT_SIZE / 2;
+
+    Crystalfontz128x128_BeginStream(x0, y - GFX_DOT_SIZE / 2, x1, y + GFX_DOT_SIZE / 2);
+
+    int row; for (row = 0; row < GFX_DOT_SIZE; row++) {
+        uint16_t runColor = background;
+        uint32_t runLength = 0;
+        int x = x0;
+
+        int i; for (i = 0; i < numX; i++) {
+            int left = dotX[i] - GFX_DOT_SIZE / 2;
+            runLength += left - x;
+            x = left;
+
+            int col; for (col = 0; col < GFX_DOT_SIZE; col++, x++) {
+                uint16_t color = (dotSprite[row] & (1 << (GFX_DOT_SIZE - 1 - col))) ? foreground : background;
+                if (runLength > 0 && color != runColor) {
+                    Crystalfontz128x128_StreamRun(runColor, runLength);
+                    runLength = 0;
+                }
+                runColor = color;
+                runLength++;
+            }
+        }
+
+        Crystalfontz128x128_StreamRun(runColor, runLength);
+    }
+
+    Crystalfontz128x128_EndStream();
+}
+
+/**
+ * Puts back the pixels a shown sprite covers, if they are still on the screen
+ */
+static void GFX_restoreSprite(GFXSprite* sprite)
+{
+    if (!sprite->visible) return;
+    sprite->visible = false;
+    if (sprite->screen != screenNumber) return;
+
+    Crystalfontz128x128_BeginStream(sprite->x, sprite->y, sprite->x + sprite->width - 1, sprite->y + sprite->height - 1);
+    Crystalfontz128x128_StreamPixels(sprite->backing, sprite->width * sprite->height);
+    Crystalfontz128x128_EndStream();
+}
+
+/**
+ * Saves what is under the sprite's new position and draws it there. Set mask
+ * bits take the sprite color; the others show the saved pixels, so only the
+ * sprite's rectangle is ever sent.
+ */
+static void GFX_drawSprite(GFX* gfx_p, GFXSprite* sprite, int x, int y)
+{
+    int x1 = x + sprite->width - 1;
+    int y1 = y + sprite->height - 1;
+
+    GFX_restoreSprite(sprite);
+
+    if (!Crystalfontz128x128_CaptureRect(x, y, x1, y1, sprite->backing)) {
+        if (sprite->capture != NULL) sprite->capture(sprite->owner_p, x, y, x1, y1, sprite->backing);
+        else {
+            int i; for (i = 0; i < sprite->width * sprite->height; i++) {
+                sprite->backing[i] = gfx_p->context.background;
+            }
+        }
+    }
+
+    uint16_t color = gfx_p->context.foreground;
+    int stride = (sprite->width + 7) / 8;
+
+    Crystalfontz128x128_BeginStream(x, y, x1, y1);
+    int row; for (row = 0; row < sprite->height; row++) {
+        int col; for (col = 0; col < sprite->width; col++) {
+            bool set = sprite->mask[row * stride + col / 8] & (0x80 >> (col % 8));
+            Crystalfontz128x128_StreamRun(set ? color : sprite->backing[row * sprite->width + col], 1);
+        }
+    }
+    Crystalfontz128x128_EndStream();
+
+    sprite->visible = true;
+    sprite->x = x;
+    sprite->y = y;
+    sprite->screen = screenNumber;
+}
+
+/**
+ * Sends a save-under area's pixels back to the screen they were taken from
+ */
+static void GFX_putBackUnder(GFXSaveUnder* area)
+{
+    if (!area->saved || area->screen != screenNumber) return;
+    area->saved = false;
+
+    uint32_t count = (uint32_t) (area->x1 - area->x0 + 1) * (area->y1 - area->y0 + 1);
+
+    Crystalfontz128x128_BeginStream(area->x0, area->y0, area->x1, area->y1);
+    Crystalfontz128x128_StreamPixels(area->pixels, count);
+    Crystalfontz128x128_EndStream();
+}
+
+/**
+ * Runs the next step of the display power-up sequence once the wait requested
+ * by the previous step has elapsed. When the controller is configured, the
+ * screen is cleared to the background color - the only full-screen fill during
+ * boot - and only then turned on, so no stale panel memory is ever shown.
+ */
+static void GFX_advanceDisplayInit(GFX* gfx_p)
+{
+    if (gfx_p->displayReady || !SWTimer_expired(&gfx_p->displayInitTimer)) return;
+
+    uint32_t wait_us = Crystalfontz128x128_InitStep();
+    if (wait_us > 0) {
+        gfx_p->displayInitTimer = SWTimer_constructUS(wait_us);
+        SWTimer_start(&gfx_p->displayInitTimer);
+        return;
+    }
+
+    Crystalfontz128x128_SetOrientation(LCD_ORIENTATION_UP);
+    gfx_p->displayReady = true;
+
+    Graphics_clearDisplay(&gfx_p->context);
+    Crystalfontz128x128_FlushDirty();
+    Crystalfontz128x128_DisplayOn();
+}
+
+// Drawing has to wait for the panel, so finish any remaining power-up steps
+static void GFX_waitForDisplay(GFX* gfx_p)
+{
+    while (!gfx_p->displayReady) GFX_advanceDisplayInit(gfx_p);
+}
+
+/**
+ * Replays one recorded draw call with the colors it was recorded with.
+ */
+static void GFX_execute(GFX* gfx_p, GFXCommand* command)
+{
+    uint32_t foreground = gfx_p->context.foreground;
+    uint32_t background = gfx_p->context.background;
+    gfx_p->context.foreground = command->foreground;
+    gfx_p->context.background = command->background;
+
+    Graphics_Rectangle rect;
+    int row;
+
+    switch (command->type) {
+    case GFX_CMD_CLEAR:
+        Graphics_clearDisplay(&gfx_p->context);
+        GFX_blankTextCells(textShown, command->background);
+        screenNumber++;
+        break;
+    case GFX_CMD_TEXT:
+        GFX_drawString(gfx_p, command->text, command->x0, command->y0);
+        break;
+    case GFX_CMD_FILL_RECT:
+        rect.sXMin = command->x0;
+        rect.sYMin = command->y0;
+        rect.sXMax = command->x1;
+        rect.sYMax = command->y1;
+        g_sCrystalfontz128x128_funcs.pfnRectFill(gfx_p->context.display, &rect, command->background);
+        break;
+    case GFX_CMD_LINE:
+        Graphics_drawLine(&gfx_p->context, command->x0, command->y0, command->x1, command->y1);
+        break;
+    case GFX_CMD_DOT_GRID:
+        for (row = 0; row < command->y0; row++) {
+            GFX_drawDotRow(gfx_p, command->dotX, command->x0, command->dotY[row]);
+        }
+        break;
+    case GFX_CMD_SPRITE_SHOW:
+        GFX_drawSprite(gfx_p, command->sprite, command->x0, command->y0);
+        break;
+    case GFX_CMD_SPRITE_HIDE:
+        GFX_restoreSprite(command->sprite);
+        break;
+    case GFX_CMD_SAVE_UNDER:
+        command->saveUnder->saved = Crystalfontz128x128_CaptureRect(command->x0, command->y0, command->x1, command->y1,
+                                                                    command->saveUnder->pixels);
+        command->saveUnder->screen = screenNumber;
+        break;
+    case GFX_CMD_RESTORE_UNDER:
+        GFX_putBackUnder(command->saveUnder);
+        break;
+    case GFX_CMD_LINE_H:
+        Graphics_drawLineH(&gfx_p->context, command->x0, command->x1, command->y0);
+        break;
+    case GFX_CMD_LINE_V:
+        Graphics_drawLineV(&gfx_p->context, command->x0, command->y0, command->y1);
+        break;
+    case GFX_CMD_SOLID_CIRCLE:
+        Graphics_fillCircle(&gfx_p->context, command->x0, command->y0, command->x1);
+        break;
+    case GFX_CMD_HOLLOW_CIRCLE:
+        Graphics_drawCircle(&gfx_p->context, command->x0, command->y0, command->x1);
+        break;
+    case GFX_CMD_IMAGE:
+        GFX_decodeImage(gfx_p, command->image, command->x0, command->y0);
+        break;
+    case GFX_CMD_REPLAY:
+        Crystalfontz128x128_ReplayDisplayList(command->displayList->pucData, command->displayList->ulLength);
+        GFX_blankTextCells(textShown, command->background);
+        screenNumber++;
+        break;
+    case GFX_CMD_TEXT_GRID:
+        GFX_drawTextGrid(gfx_p);
+        break;
+    }
+
+    gfx_p->context.foreground = foreground;
+    gfx_p->context.background = background;
+}
+
+/**
+ * Marks the text grid cells a queued call is about to draw over, other than
+ * by a grid flush. Clears and replays start the grid afresh instead.
+ */
+static void GFX_coverCommand(GFX* gfx_p, const GFXCommand* command)
+{
+    const GFXSprite* sprite = command->sprite;
+    int row;
+    int width = Graphics_getFontMaxWidth(gfx_p->context.font);
+    int height = Graphics_getFontHeight(gfx_p->context.font);
+    int x0 = command->x0, y0 = command->y0, x1 = command->x1, y1 = command->y1;
+
+    switch (command->type) {
+    case GFX_CMD_TEXT:
+        x1 = x0 + (int) strlen(command->text) * width - 1;
+        y1 = y0 + height - 1;
+        break;
+    case GFX_CMD_LINE:
+        break;
+    case GFX_CMD_LINE_H:
+        y1 = y0;
+        break;
+    case GFX_CMD_LINE_V:
+        x1 = x0;
+        break;
+    case GFX_CMD_SOLID_CIRCLE:
+    case GFX_CMD_HOLLOW_CIRCLE:
+        x0 = command->x0 - command->x1;
+        y0 = command->y0 - command->x1;
+        x1 = command->x0 + command->x1;
+        y1 = command->y0 + command->x1;
+        break;
+    case GFX_CMD_IMAGE:
+        x1 = x0 + command->image->width - 1;
+        y1 = y0 + command->image->height - 1;
+        break;
+    case GFX_CMD_DOT_GRID:
+        // Columns are in increasing order; rows need not be
+        x0 = command->dotX[0] - GFX_DOT_SIZE / 2;
+        x1 = command->dotX[command->x0 - 1] + GFX_DOT_SIZE / 2;
+        for (row = 0; row < command->y0; row++) {
+            GFX_coverText(x0, command->dotY[row] - GFX_DOT_SIZE / 2, x1, command->dotY[row] + GFX_DOT_SIZE / 2,
+                          command->call);
+        }
+        return;
+    case GFX_CMD_SPRITE_SHOW:
+    case GFX_CMD_SPRITE_HIDE:
+        if (sprite->visible) {
+            GFX_coverText(sprite->x, sprite->y, sprite->x + sprite->width - 1, sprite->y + sprite->height - 1, command->call);
+        }
+        if (command->type == GFX_CMD_SPRITE_HIDE) return;
+        x1 = x0 + sprite->width - 1;
+        y1 = y0 + sprite->height - 1;
+        break;
+    case GFX_CMD_RESTORE_UNDER:
+        x0 = command->saveUnder->x0;
+        y0 = command->saveUnder->y0;
+        x1 = command->saveUnder->x1;
+        y1 = command->saveUnder->y1;
+        break;
+    case GFX_CMD_FILL_RECT:
+        break;
+    default:
+        return;
+    }
+
+    GFX_coverText(x0, y0, x1, y1, command->call);
+}
+
+// Renders the call at the head of the queue
+static void GFX_renderNext(GFX* gfx_p)
+{
+    GFXCommand* command = &renderQueue[renderHead];
+
+    GFX_coverCommand(gfx_p, command);
+    GFX_execute(gfx_p, command);
+    renderHead = (renderHead + 1) % GFX_QUEUE_SIZE;
+    renderCount--;
+    if (frameCount > 0) frameCount--;
+}
+
+/**
+ * Replays queued draw calls in order. Unless told to drain the whole queue, it
+ * stops once the render budget is used up, leaving the rest for the next
+ * super-loop. Nearly every call leaves a transfer running, so before the next
+ * one it waits for the LCD to go idle, but only until the budget runs out: a
+ * call started on a busy LCD would block inside the driver until a transfer
+ * as long as a full-screen fill had finished.
+ */
+static void GFX_render(GFX* gfx_p, bool drainAll)
+{
+    if (drainAll) GFX_waitForDisplay(gfx_p);
+    if (!gfx_p->displayReady) return;
+
+    SWTimer budget = SWTimer_constructUS(GFX_RENDER_BUDGET_US);
+    SWTimer_start(&budget);
+
+    while (renderCount > 0 && (drainAll || frameCount > 0)) {
+        if (!drainAll) {
+            while (Crystalfontz128x128_IsBusy() && !SWTimer_expired(&budget))
+                ;
+            if (Crystalfontz128x128_IsBusy() || SWTimer_expired(&budget)) break;
+        }
+
+        GFX_renderNext(gfx_p);
+    }
+
+    if (drainAll) frameCount = 0;
+}
+
+/**
+ * Returns a new entry at the back of the render queue, filled in with the
+ * current colors. When the queue is full, the oldest call is rendered right
+ * away to make room.
+ */
+static GFXCommand* GFX_enqueue(GFX* gfx_p, GFXCommandType type)
+{
+    if (renderCount == GFX_QUEUE_SIZE) {
+        GFX_waitForDisplay(gfx_p);
+        GFX_renderNext(gfx_p);
+    }
+
+    GFXCommand* command = &renderQueue[(renderHead + renderCount) % GFX_QUEUE_SIZE];
+    renderCount++;
+
+    command->call = queuedCalls++;
+
+    // Text written from now on must be flushed after this call
+    if (type != GFX_CMD_TEXT_GRID) textFlushQueued = false;
+
+    command->type = type;
+    command->foreground = gfx_p->context.foreground;
+    command->background = gfx_p->context.background;
+
+    return command;
+}
+
 GFX GFX_construct(uint32_t defaultForeground, uint32_t defaultBackground)
 {
     GFX gfx;
@@ -14,81 +712,347 @@ GFX GFX_construct(uint32_t defaultForeground, uint32_t defaultBackground)
     gfx.defaultForeground = defaultForeground;
     gfx.defaultBackground = defaultBackground;
 
-    // initializing the display
-    Crystalfontz128x128_Init();
-    Crystalfontz128x128_SetOrientation(LCD_ORIENTATION_UP);
-
-    // setting up the graphics
+    // setting up the graphics - this does not touch the panel yet
     Graphics_initContext(&gfx.context, &g_sCrystalfontz128x128, &g_sCrystalfontz128x128_funcs);
     Graphics_setFont(&gfx.context, &g_sFontFixed6x8);
 
     GFX_resetColors(&gfx);
-    GFX_clear(&gfx);
+
+    GFX_blankTextCells(textCells, gfx.context.background);
+    GFX_blankTextCells(textShown, gfx.context.background);
+
+    // starting the display power-up; the rest happens in GFX_refresh() or
+    // right before the first draw
+    gfx.consoleActive = false;
+    gfx.displayReady = false;
+    gfx.displayInitTimer = SWTimer_construct(0);
+    SWTimer_start(&gfx.displayInitTimer);
+    GFX_advanceDisplayInit(&gfx);
+
+    gfx.frameTimer = SWTimer_constructUS(GFX_FRAME_US);
+    SWTimer_start(&gfx.frameTimer);
+    gfx.frameStarted = false;
 
     return gfx;
 }
 
 void GFX_resetColors(GFX* gfx_p)
 {
-    gfx_p->foreground = gfx_p->defaultForeground;
-    gfx_p->background = gfx_p->defaultBackground;
+    GFX_setForeground(gfx_p, gfx_p->defaultForeground);
+    GFX_setBackground(gfx_p, gfx_p->defaultBackground);
+}
 
-    Graphics_setForegroundColor(&gfx_p->context, gfx_p->defaultForeground);
-    Graphics_setBackgroundColor(&gfx_p->context, gfx_p->defaultBackground);
+/**
+ * Prepares for a draw call which repaints the whole screen. A repainted
+ * screen has no console left to scroll, and anything still queued would be
+ * painted over, so it is dropped.
+ */
+static void GFX_discardScreen(GFX* gfx_p)
+{
+    if (gfx_p->consoleActive) {
+        GFX_waitForDisplay(gfx_p);
+        Crystalfontz128x128_StopScroll();
+        gfx_p->consoleActive = false;
+    }
+
+    renderCount = 0;
+    frameCount = 0;
+
+    // The grid starts over blank; the panel side is blanked when the
+    // repaint is actually drawn
+    GFX_blankTextCells(textCells, gfx_p->context.background);
+    textFlushQueued = false;
 }
 
 void GFX_clear(GFX* gfx_p)
 {
-    Graphics_clearDisplay(&gfx_p->context);
+    GFX_discardScreen(gfx_p);
+    GFX_enqueue(gfx_p, GFX_CMD_CLEAR);
 }
 
-void GFX_print(GFX* gfx_p, char* string, float row, float col)
+/**
+ * A frame is announced once the frame timer has run out and the previous
+ * frame is fully rendered. It takes in the queue on the next refresh, after
+ * the application has had one super-loop to draw into it.
+ */
+void GFX_refresh(GFX* gfx_p)
 {
-    int yPosition = row * Graphics_getFontHeight(gfx_p->context.font);
-    int xPosition = col * Graphics_getFontMaxWidth(gfx_p->context.font);
+    GFX_advanceDisplayInit(gfx_p);
 
-    Graphics_drawString(&gfx_p->context, (int8_t*) string, -1, xPosition, yPosition, OPAQUE_TEXT);
+    if (gfx_p->frameStarted) {
+        gfx_p->frameStarted = false;
+        frameCount = renderCount;
+    }
+    else if (frameCount == 0 && SWTimer_expired(&gfx_p->frameTimer)) {
+        SWTimer_start(&gfx_p->frameTimer);
+        gfx_p->frameStarted = true;
+    }
+
+    GFX_render(gfx_p, false);
+    if (gfx_p->displayReady) Crystalfontz128x128_FlushDirty();
 }
 
-void GFX_eraseText(GFX* gfx_p, char* string, float row, float col) {
-    uint32_t oldForegroundColor = gfx_p->foreground;
-    GFX_setForeground(gfx_p, gfx_p->background);
+void GFX_flush(GFX* gfx_p)
+{
+    GFX_render(gfx_p, true);
+    Graphics_flushBuffer(&gfx_p->context);
+}
 
-    int yPosition = row * Graphics_getFontHeight(gfx_p->context.font);
-    int xPosition = col * Graphics_getFontMaxWidth(gfx_p->context.font);
+bool GFX_isFrameStart(GFX* gfx_p)
+{
+    return gfx_p->frameStarted;
+}
 
-    Graphics_drawString(&gfx_p->context, (int8_t*)string, -1, xPosition, yPosition, OPAQUE_TEXT);
+bool GFX_isIdle(GFX* gfx_p)
+{
+    return renderCount == 0;
+}
 
-    GFX_setForeground(gfx_p, oldForegroundColor);
+bool GFX_isReady(GFX* gfx_p)
+{
+    return gfx_p->displayReady;
+}
+
+void GFX_print(GFX* gfx_p, char* string, GFXFixed row, GFXFixed col)
+{
+    int yPosition = GFX_FIXED_TO_INT(row * Graphics_getFontHeight(gfx_p->context.font));
+    int xPosition = GFX_FIXED_TO_INT(col * Graphics_getFontMaxWidth(gfx_p->context.font));
+
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_TEXT);
+    command->x0 = xPosition;
+    command->y0 = yPosition;
+    strncpy(command->text, string, GFX_TEXT_MAX);
+    command->text[GFX_TEXT_MAX] = '\0';
+}
+
+// Erasing opaque text is the same as filling its cells with the background,
+// which avoids swapping colors (and flushing the glyph cache) twice.
+void GFX_eraseText(GFX* gfx_p, char* string, GFXFixed row, GFXFixed col) {
+    int yPosition = GFX_FIXED_TO_INT(row * Graphics_getFontHeight(gfx_p->context.font));
+    int xPosition = GFX_FIXED_TO_INT(col * Graphics_getFontMaxWidth(gfx_p->context.font));
+
+    Graphics_Rectangle rect;
+    rect.sXMin = xPosition;
+    rect.sYMin = yPosition;
+    rect.sXMax = xPosition + strlen(string) * Graphics_getFontMaxWidth(gfx_p->context.font) - 1;
+    rect.sYMax = yPosition + Graphics_getFontHeight(gfx_p->context.font) - 1;
+
+    if (rect.sXMin < 0) rect.sXMin = 0;
+    if (rect.sYMin < 0) rect.sYMin = 0;
+    if (rect.sXMax > LCD_HORIZONTAL_MAX - 1) rect.sXMax = LCD_HORIZONTAL_MAX - 1;
+    if (rect.sYMax > LCD_VERTICAL_MAX - 1) rect.sYMax = LCD_VERTICAL_MAX - 1;
+    if (rect.sXMin > rect.sXMax || rect.sYMin > rect.sYMax) return;
+
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_FILL_RECT);
+    command->x0 = rect.sXMin;
+    command->y0 = rect.sYMin;
+    command->x1 = rect.sXMax;
+    command->y1 = rect.sYMax;
 }
 
-int GFX_printTextRows(GFX* gfx_p, char* strings[], int numStrings, float firstRow, float col) {
+GFXFixed GFX_printTextRows(GFX* gfx_p, char* strings[], int numStrings, GFXFixed firstRow, GFXFixed col) {
     int i; for (i = 0; i < numStrings; i++) {
-        GFX_print(gfx_p, strings[i], firstRow++, col);
+        GFX_print(gfx_p, strings[i], firstRow, col);
+        firstRow += GFX_FIXED_INT(1);
     }
     return firstRow;
 }
 
+static void GFX_queueTextFlush(GFX* gfx_p)
+{
+    if (textFlushQueued) return;
+
+    GFX_enqueue(gfx_p, GFX_CMD_TEXT_GRID);
+    textFlushQueued = true;
+}
+
+void GFX_setText(GFX* gfx_p, char* string, int row, int col)
+{
+    if (row < 0 || row >= GFX_TEXT_ROWS) return;
+
+    for (; *string && col < GFX_TEXT_COLS; string++, col++) {
+        if (col < 0) continue;
+
+        textCells[row][col].c = *string;
+        textCells[row][col].foreground = gfx_p->context.foreground;
+        textCells[row][col].background = gfx_p->context.background;
+        textWritten[row][col] = queuedCalls;
+    }
+
+    GFX_queueTextFlush(gfx_p);
+}
+
+void GFX_clearText(GFX* gfx_p, int row, int col, int length)
+{
+    if (row < 0 || row >= GFX_TEXT_ROWS) return;
+
+    for (; length > 0 && col < GFX_TEXT_COLS; length--, col++) {
+        if (col < 0) continue;
+
+        textCells[row][col].c = ' ';
+        textCells[row][col].foreground = gfx_p->context.foreground;
+        textCells[row][col].background = gfx_p->context.background;
+        textWritten[row][col] = queuedCalls;
+    }
+
+    GFX_queueTextFlush(gfx_p);
+}
+
+/**
+ * Turns text rows [firstRow, firstRow + numRows) into a scrolling console and
+ * clears them. Returns false if the band does not fit on the screen or the
+ * panel cannot scroll in its current orientation.
+ */
+bool GFX_startConsole(GFX* gfx_p, int firstRow, int numRows)
+{
+    int height = Graphics_getFontHeight(gfx_p->context.font);
+    int top = firstRow * height;
+    int bottom = (firstRow + numRows) * height - 1;
+
+    if (numRows <= 0 || top < 0 || bottom > LCD_VERTICAL_MAX - 1) return false;
+
+    // Queued draw calls have to land before the memory starts to move
+    GFX_render(gfx_p, true);
+    if (gfx_p->consoleActive) GFX_stopConsole(gfx_p);
+
+    Crystalfontz128x128_FlushDirty();
+    if (!Crystalfontz128x128_SetScrollArea(top, bottom)) return false;
+
+    Graphics_Rectangle rect;
+    rect.sXMin = 0;
+    rect.sYMin = top;
+    rect.sXMax = LCD_HORIZONTAL_MAX - 1;
+    rect.sYMax = bottom;
+    g_sCrystalfontz128x128_funcs.pfnRectFill(gfx_p->context.display, &rect, gfx_p->context.background);
+    GFX_coverTextNow(rect.sXMin, rect.sYMin, rect.sXMax, rect.sYMax);
+
+    gfx_p->consoleActive = true;
+    gfx_p->consoleFirstRow = firstRow;
+    gfx_p->consoleNumRows = numRows;
+    gfx_p->consoleUsedRows = 0;
+    gfx_p->consoleScroll = 0;
+
+    return true;
+}
+
+/**
+ * Adds a line at the bottom of the console. Until the console is full lines
+ * simply fill it from the top; after that, the oldest line is overwritten
+ * with the new one and the panel is scrolled up by one text row, so the cost
+ * is one row of text regardless of how many lines are shown. Lines longer
+ * than the screen is wide wrap onto further rows.
+ */
+void GFX_consolePrint(GFX* gfx_p, char* line)
+{
+    if (!gfx_p->consoleActive) return;
+
+    // Console lines are drawn straight away, after anything queued before them
+    GFX_render(gfx_p, true);
+
+    int height = Graphics_getFontHeight(gfx_p->context.font);
+    int width = Graphics_getFontMaxWidth(gfx_p->context.font);
+    int columns = LCD_HORIZONTAL_MAX / width;
+    int length = strlen(line);
+
+    do {
+        int row;
+        if (gfx_p->consoleUsedRows < gfx_p->consoleNumRows) {
+            row = gfx_p->consoleUsedRows++;
+        }
+        else {
+            // The row shown on top is the oldest; it becomes the new bottom
+            row = gfx_p->consoleScroll;
+            gfx_p->consoleScroll = (gfx_p->consoleScroll + 1) % gfx_p->consoleNumRows;
+        }
+
+        int y = (gfx_p->consoleFirstRow + row) * height;
+        int count = length < columns ? length : columns;
+
+        char chunk[LCD_HORIZONTAL_MAX + 1];
+        memcpy(chunk, line, count);
+        chunk[count] = '\0';
+        GFX_drawString(gfx_p, chunk, 0, y);
+
+        // Clearing whatever is left of the old line to the right of the text
+        Graphics_Rectangle rect;
+        rect.sXMin = count * width;
+        rect.sYMin = y;
+        rect.sXMax = LCD_HORIZONTAL_MAX - 1;
+        rect.sYMax = y + height - 1;
+        if (rect.sXMin <= rect.sXMax) {
+            g_sCrystalfontz128x128_funcs.pfnRectFill(gfx_p->context.display, &rect, gfx_p->context.background);
+        }
+
+        // Scrolling moves every row of the console on screen
+        GFX_coverTextNow(0, gfx_p->consoleFirstRow * height, LCD_HORIZONTAL_MAX - 1,
+                         (gfx_p->consoleFirstRow + gfx_p->consoleNumRows) * height - 1);
+
+        // The new row has to be in panel memory before it is scrolled into view
+        Crystalfontz128x128_FlushDirty();
+        Crystalfontz128x128_SetScrollOffset(gfx_p->consoleScroll * height);
+
+        line += count;
+        length -= count;
+    } while (length > 0);
+}
+
+/**
+ * Stops scrolling and clears the console rows, since their contents are no
+ * longer in on-screen order once the panel stops scrolling.
+ */
+void GFX_stopConsole(GFX* gfx_p)
+{
+    if (!gfx_p->consoleActive) return;
+
+    int height = Graphics_getFontHeight(gfx_p->context.font);
+
+    GFX_render(gfx_p, true);
+    Crystalfontz128x128_StopScroll();
+    gfx_p->consoleActive = false;
+
+    Graphics_Rectangle rect;
+    rect.sXMin = 0;
+    rect.sYMin = gfx_p->consoleFirstRow * height;
+    rect.sXMax = LCD_HORIZONTAL_MAX - 1;
+    rect.sYMax = (gfx_p->consoleFirstRow + gfx_p->consoleNumRows) * height - 1;
+    g_sCrystalfontz128x128_funcs.pfnRectFill(gfx_p->context.display, &rect, gfx_p->context.background);
+    GFX_coverTextNow(rect.sXMin, rect.sYMin, rect.sXMax, rect.sYMax);
+}
+
 void GFX_setForeground(GFX* gfx_p, uint32_t foreground)
 {
     gfx_p->foreground = foreground;
     Graphics_setForegroundColor(&gfx_p->context, foreground);
+
+    // Cached glyphs were expanded for the old color pair
+    if (glyphForeground != gfx_p->context.foreground) GFX_invalidateGlyphs();
+    glyphForeground = gfx_p->context.foreground;
 }
 
 void GFX_setBackground(GFX* gfx_p, uint32_t background)
 {
     gfx_p->background = background;
     Graphics_setBackgroundColor(&gfx_p->context, background);
+
+    // Cached glyphs were expanded for the old color pair
+    if (glyphBackground != gfx_p->context.background) GFX_invalidateGlyphs();
+    glyphBackground = gfx_p->context.background;
 }
 
 void GFX_drawSolidCircle(GFX* gfx_p, int x, int y, int radius)
 {
-    Graphics_fillCircle(&gfx_p->context, x, y, radius);
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_SOLID_CIRCLE);
+    command->x0 = x;
+    command->y0 = y;
+    command->x1 = radius;
 }
 
 void GFX_drawHollowCircle(GFX* gfx_p, int x, int y, int radius)
 {
-    Graphics_drawCircle(&gfx_p->context, x, y, radius);
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_HOLLOW_CIRCLE);
+    command->x0 = x;
+    command->y0 = y;
+    command->x1 = radius;
 }
 
 void GFX_removeSolidCircle(GFX* gfx_p, int x, int y, int radius)
@@ -108,5 +1072,180 @@ void GFX_removeHollowCircle(GFX* gfx_p, int x, int y, int radius)
 }
 
 void GFX_drawLine(GFX* gfx_p, int x1, int x2, int y1, int y2) {
-    Graphics_drawLine(&gfx_p->context, x1, y1, x2, y2);
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_LINE);
+    command->x0 = x1;
+    command->y0 = y1;
+    command->x1 = x2;
+    command->y1 = y2;
+}
+
+void GFX_fillRect(GFX* gfx_p, int x1, int y1, int x2, int y2)
+{
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 > LCD_HORIZONTAL_MAX - 1) x2 = LCD_HORIZONTAL_MAX - 1;
+    if (y2 > LCD_VERTICAL_MAX - 1) y2 = LCD_VERTICAL_MAX - 1;
+    if (x1 > x2 || y1 > y2) return;
+
+    // The fill command paints with its background color
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_FILL_RECT);
+    command->background = command->foreground;
+    command->x0 = x1;
+    command->y0 = y1;
+    command->x1 = x2;
+    command->y1 = y2;
+}
+
+void GFX_drawLineH(GFX* gfx_p, int x1, int x2, int y)
+{
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_LINE_H);
+    command->x0 = x1;
+    command->x1 = x2;
+    command->y0 = y;
+}
+
+void GFX_drawLineV(GFX* gfx_p, int x, int y1, int y2)
+{
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_LINE_V);
+    command->x0 = x;
+    command->y0 = y1;
+    command->y1 = y2;
+}
+
+void GFX_drawDotGrid(GFX* gfx_p, const int* dotX, int numX, const int* dotY, int numY)
+{
+    if (numX < 1 || numY < 1) return;
+
+    int i; for (i = 0; i < numX; i++) {
+        if (dotX[i] < GFX_DOT_SIZE / 2 || dotX[i] >= LCD_HORIZONTAL_MAX - GFX_DOT_SIZE / 2) return;
+        if (i > 0 && dotX[i] - dotX[i - 1] < GFX_DOT_SIZE) return;
+    }
+    for (i = 0; i < numY; i++) {
+        if (dotY[i] < GFX_DOT_SIZE / 2 || dotY[i] >= LCD_VERTICAL_MAX - GFX_DOT_SIZE / 2) return;
+    }
+
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_DOT_GRID);
+    command->dotX = dotX;
+    command->dotY = dotY;
+    command->x0 = numX;
+    command->y0 = numY;
+}
+
+void GFX_drawImage(GFX* gfx_p, const GFXImage* image_p, int x, int y)
+{
+    if (x < 0 || y < 0 || x + image_p->width > LCD_HORIZONTAL_MAX || y + image_p->height > LCD_VERTICAL_MAX) return;
+
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_IMAGE);
+    command->image = image_p;
+    command->x0 = x;
+    command->y0 = y;
+}
+
+GFXSprite GFX_constructSprite(uint8_t width, uint8_t height, const uint8_t* mask, uint32_t color,
+                              GFXSpriteCapture capture, void* owner_p)
+{
+    GFXSprite sprite;
+
+    sprite.width = width;
+    sprite.height = height;
+    sprite.mask = mask;
+    sprite.color = color;
+    sprite.capture = capture;
+    sprite.owner_p = owner_p;
+    sprite.visible = false;
+
+    return sprite;
+}
+
+void GFX_showSprite(GFX* gfx_p, GFXSprite* sprite_p, int x, int y)
+{
+    if (sprite_p->width * sprite_p->height > GFX_SPRITE_MAX_PIXELS) return;
+    if (x < 0 || y < 0 || x + sprite_p->width > LCD_HORIZONTAL_MAX || y + sprite_p->height > LCD_VERTICAL_MAX) return;
+
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_SPRITE_SHOW);
+    command->foreground = GFX_nativeColor(gfx_p, sprite_p->color);
+    command->sprite = sprite_p;
+    command->x0 = x;
+    command->y0 = y;
+}
+
+void GFX_hideSprite(GFX* gfx_p, GFXSprite* sprite_p)
+{
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_SPRITE_HIDE);
+    command->sprite = sprite_p;
+}
+
+bool GFX_canSaveUnder(void)
+{
+    return Crystalfontz128x128_CanCapture();
+}
+
+void GFX_saveUnder(GFX* gfx_p, GFXSaveUnder* area_p, uint16_t* pixels, int x0, int y0, int x1, int y1)
+{
+    area_p->x0 = x0;
+    area_p->y0 = y0;
+    area_p->x1 = x1;
+    area_p->y1 = y1;
+    area_p->pixels = NULL;
+    area_p->saved = false;
+
+    if (!GFX_canSaveUnder()) return;
+    if (x0 < 0 || y0 < 0 || x1 >= LCD_HORIZONTAL_MAX || y1 >= LCD_VERTICAL_MAX || x0 > x1 || y0 > y1) return;
+    area_p->pixels = pixels;
+
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_SAVE_UNDER);
+    command->saveUnder = area_p;
+    command->x0 = x0;
+    command->y0 = y0;
+    command->x1 = x1;
+    command->y1 = y1;
+}
+
+bool GFX_restoreUnder(GFX* gfx_p, GFXSaveUnder* area_p)
+{
+    if (!GFX_canSaveUnder() || area_p->pixels == NULL) return false;
+
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_RESTORE_UNDER);
+    command->saveUnder = area_p;
+    return true;
+}
+
+uint16_t GFX_nativeColor(GFX* gfx_p, uint32_t color)
+{
+    return g_sCrystalfontz128x128_funcs.pfnColorTranslate(gfx_p->context.display, color);
+}
+
+/**
+ * Starts recording a display list. Draw calls already queued are rendered
+ * first, so that only what is drawn from here on ends up in the list.
+ */
+void GFX_startRecording(GFX* gfx_p, Crystalfontz128x128_DisplayList* list_p)
+{
+    GFX_render(gfx_p, true);
+    Crystalfontz128x128_BeginRecording(list_p);
+}
+
+/**
+ * Renders everything drawn since GFX_startRecording() and stops recording.
+ * Returns false if the list ran out of space, in which case it is left empty.
+ */
+bool GFX_stopRecording(GFX* gfx_p)
+{
+    GFX_render(gfx_p, true);
+    return Crystalfontz128x128_EndRecording();
+}
+
+/**
+ * Queues a replay of a recorded display list in place of whatever else is
+ * waiting to be drawn.
+ */
+bool GFX_replay(GFX* gfx_p, const Crystalfontz128x128_DisplayList* list_p)
+{
+    if (list_p->ulLength == 0) return false;
+
+    GFX_discardScreen(gfx_p);
+    GFXCommand* command = GFX_enqueue(gfx_p, GFX_CMD_REPLAY);
+    command->displayList = list_p;
+
+    return true;
 }
@@ -9,12 +9,145 @@
 #define HAL_GRAPHICS_H_
 
 #include <HAL/LcdDriver/Crystalfontz128x128_ST7735.h>
+#include <HAL/Timer.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include <ti/grlib/grlib.h>
 
+// Fixed-point coordinates in Q8.8: text rows and columns, and layout positions,
+// may fall halfway between cells or pixels without any float math. GFX_FIXED()
+// is meant for constants, which the compiler folds; GFX_FIXED_INT() converts a
+// variable integer.
+typedef int32_t GFXFixed;
+#define GFX_FIXED_SHIFT 8
+#define GFX_FIXED(x) ((GFXFixed) ((x) * (1 << GFX_FIXED_SHIFT)))
+#define GFX_FIXED_INT(n) ((GFXFixed) (n) * (1 << GFX_FIXED_SHIFT))
+#define GFX_FIXED_TO_INT(f) ((int) ((f) >> GFX_FIXED_SHIFT))
+
 #define FG_COLOR GRAPHICS_COLOR_WHITE
 #define BG_COLOR GRAPHICS_COLOR_BLACK
 
+// Glyphs of g_sFontFixed6x8 are cached pre-expanded to native pixels for the current
+// foreground/background pair, one entry per printable character.
+#define GLYPH_FIRST_CHAR ' '
+#define GLYPH_LAST_CHAR '~'
+#define GLYPH_NUM_CHARS (GLYPH_LAST_CHAR - GLYPH_FIRST_CHAR + 1)
+#define GLYPH_MAX_WIDTH 6
+#define GLYPH_MAX_HEIGHT 8
+
+// Draw calls are recorded into a bounded queue and replayed by GFX_refresh(),
+// which stops after GFX_RENDER_BUDGET_US each super-loop so that input and
+// UART handling are never held up for long by a repaint. Rendering is paced in
+// frames of GFX_FRAME_US: a frame takes in everything queued since the last
+// one, so changes made several times within a frame reach the panel once. Text is copied into
+// the queue, up to one screen width of characters.
+#define GFX_QUEUE_SIZE 64
+#define GFX_RENDER_BUDGET_US 1000
+#define GFX_FRAME_US 33333
+#define GFX_TEXT_MAX (LCD_HORIZONTAL_MAX / GLYPH_MAX_WIDTH)
+
+// A run-length-encoded image asset, as produced by tools/img2rle.py. The
+// pixels are palette indices in raster order, stored as a series of runs that
+// may cross row boundaries. A run starts with a header byte:
+//   0nnnnnnn idx         - n + 1 pixels of palette entry idx
+//   1nnnnnnn <indices>   - n + 1 literal indices, bpp bits each, MSB first,
+//                          padded to a whole byte
+struct _GFXImage
+{
+    uint8_t bpp;               // bits per literal index: 1, 4 or 8
+    uint16_t width;
+    uint16_t height;
+    const uint32_t* palette;   // 24-bit RGB colors
+    const uint8_t* runs;
+};
+typedef struct _GFXImage GFXImage;
+
+// The text grid: the screen as GFX_TEXT_ROWS x GFX_TEXT_COLS character cells
+// of the 6x8 font. Each cell keeps its character and the panel-native colors
+// it was written with, so that only cells which changed are ever redrawn.
+#define GFX_TEXT_COLS (LCD_HORIZONTAL_MAX / GLYPH_MAX_WIDTH)
+#define GFX_TEXT_ROWS (LCD_VERTICAL_MAX / GLYPH_MAX_HEIGHT)
+
+// Width and height of a board dot drawn by GFX_drawDotGrid()
+#define GFX_DOT_SIZE 3
+
+struct _GFXTextCell
+{
+    char c;
+    uint16_t foreground;
+    uint16_t background;
+};
+typedef struct _GFXTextCell GFXTextCell;
+
+// A sprite: a one-color shape drawn over the screen which can be moved and
+// removed without redrawing what is under it. While it is shown, the pixels
+// it covers are kept in its backing store. They are captured from the LCD
+// driver's shadow buffer or read back from the panel when the driver can,
+// and otherwise from the sprite's capture function, which has to fill in the native colors of what
+// the owner drew there (GFX_nativeColor() translates them). Without either
+// the sprite assumes it sits on background. Nothing else may draw under a
+// shown sprite: hide it first, and show it again afterwards.
+#define GFX_SPRITE_MAX_PIXELS 64
+
+typedef void (*GFXSpriteCapture)(void* owner_p, int x0, int y0, int x1, int y1, uint16_t* pixels);
+
+struct _GFXSprite
+{
+    uint8_t width;
+    uint8_t height;
+    const uint8_t* mask;        // 1 bit per pixel, MSB first, rows padded to a whole byte
+    uint32_t color;
+    GFXSpriteCapture capture;
+    void* owner_p;
+
+    // Where the sprite is shown, updated as the render queue reaches it
+    bool visible;
+    int16_t x, y;
+    uint16_t screen;            // The screen it was shown on, see GFX_CMD_CLEAR
+    uint16_t backing[GFX_SPRITE_MAX_PIXELS];
+};
+typedef struct _GFXSprite GFXSprite;
+
+// A save-under area for pop-ups drawn over a screen. GFX_saveUnder() copies
+// what is in the rectangle before the pop-up is drawn there, and
+// GFX_restoreUnder() puts it back, so the screen underneath never has to be
+// drawn again. The copy comes from the LCD driver's shadow buffer or panel
+// readback; builds with neither cannot save, see GFX_canSaveUnder().
+struct _GFXSaveUnder
+{
+    int16_t x0, y0, x1, y1;
+    uint16_t* pixels;           // Room for the whole rectangle, row by row
+    bool saved;
+    uint16_t screen;
+};
+typedef struct _GFXSaveUnder GFXSaveUnder;
+
+enum _GFXCommandType { GFX_CMD_CLEAR, GFX_CMD_TEXT, GFX_CMD_FILL_RECT, GFX_CMD_LINE,
+                       GFX_CMD_SOLID_CIRCLE, GFX_CMD_HOLLOW_CIRCLE, GFX_CMD_REPLAY,
+                       GFX_CMD_IMAGE, GFX_CMD_TEXT_GRID, GFX_CMD_LINE_H, GFX_CMD_LINE_V,
+                       GFX_CMD_DOT_GRID, GFX_CMD_SPRITE_SHOW, GFX_CMD_SPRITE_HIDE,
+                       GFX_CMD_SAVE_UNDER, GFX_CMD_RESTORE_UNDER };
+typedef enum _GFXCommandType GFXCommandType;
+
+// One recorded draw call. The colors are the panel-native colors that were
+// current when the call was made; circles keep their radius in x1, and dot
+// grids their number of columns and rows in x0 and y0.
+struct _GFXCommand
+{
+    GFXCommandType type;
+    uint32_t call;              // Its number in queue order
+    uint32_t foreground;
+    uint32_t background;
+    int16_t x0, y0, x1, y1;
+    char text[GFX_TEXT_MAX + 1];
+    const Crystalfontz128x128_DisplayList* displayList;
+    const GFXImage* image;
+    const int* dotX;
+    const int* dotY;
+    GFXSprite* sprite;
+    GFXSaveUnder* saveUnder;
+};
+typedef struct _GFXCommand GFXCommand;
+
 struct _GFX
 {
     Graphics_Context context;
@@ -22,6 +155,25 @@ struct _GFX
     uint32_t background;
     uint32_t defaultForeground;
     uint32_t defaultBackground;
+
+    // The LCD is brought up by a non-blocking FSM: the timer measures the wait
+    // the panel asked for before its next power-up step.
+    SWTimer displayInitTimer;
+    bool displayReady;
+
+    // Times the render frames. frameStarted is set for the one super-loop in
+    // which a new frame is announced, before it takes in the draw queue.
+    SWTimer frameTimer;
+    bool frameStarted;
+
+    // Scrolling console on text rows [consoleFirstRow, consoleFirstRow + consoleNumRows).
+    // Lines are added at the bottom and the older ones are moved up by the
+    // panel's hardware scrolling, so only the new line is ever drawn.
+    bool consoleActive;
+    int consoleFirstRow;
+    int consoleNumRows;
+    int consoleUsedRows;
+    int consoleScroll;
 };
 typedef struct _GFX GFX;
 
@@ -30,10 +182,43 @@ GFX GFX_construct(uint32_t defaultForeground, uint32_t defaultBackground);
 void GFX_resetColors(GFX* gfx_p);
 void GFX_clear(GFX* gfx_p);
 
-void GFX_print(GFX* gfx_p, char* string, float row, float col);
-void GFX_eraseText(GFX* gfx_p, char* string, float row, float col);
+// Advances the display power-up sequence and pushes any drawing still held in
+// the LCD shadow buffer out to the panel. Call once per super-loop.
+void GFX_refresh(GFX* gfx_p);
+
+// Returns true for one super-loop at the start of each frame. Whatever is drawn
+// during that loop goes out in the new frame, so state that changes often
+// should be drawn only then.
+bool GFX_isFrameStart(GFX* gfx_p);
+
+// Blocks until everything drawn so far is visible on the panel
+void GFX_flush(GFX* gfx_p);
+
+// Returns true when no draw calls are waiting to be rendered
+bool GFX_isIdle(GFX* gfx_p);
+
+// Returns true once the display has finished powering up
+bool GFX_isReady(GFX* gfx_p);
+
+// Text positions are in rows and columns of the font, as GFXFixed values
+void GFX_print(GFX* gfx_p, char* string, GFXFixed row, GFXFixed col);
+void GFX_eraseText(GFX* gfx_p, char* string, GFXFixed row, GFXFixed col);
 
-int GFX_printTextRows(GFX* gfx_p, char* strings[], int numStrings, float firstRow, float col);
+// Prints one string per row and returns the row after the last one
+GFXFixed GFX_printTextRows(GFX* gfx_p, char* strings[], int numStrings, GFXFixed firstRow, GFXFixed col);
+
+// Write into and erase cells of the text grid with the current colors. Only
+// cells whose character or colors end up different from what is on the panel
+// are redrawn, with each horizontal run of them sent through one draw window.
+// GFX_clear() and GFX_replay() blank the whole grid.
+void GFX_setText(GFX* gfx_p, char* string, int row, int col);
+void GFX_clearText(GFX* gfx_p, int row, int col, int length);
+
+// Turns a band of text rows into a scrolling console. While it is active,
+// nothing else should be drawn inside that band.
+bool GFX_startConsole(GFX* gfx_p, int firstRow, int numRows);
+void GFX_consolePrint(GFX* gfx_p, char* line);
+void GFX_stopConsole(GFX* gfx_p);
 
 void GFX_setForeground(GFX* gfx_p, uint32_t foreground);
 void GFX_setBackground(GFX* gfx_p, uint32_t background);
@@ -46,4 +231,58 @@ void GFX_removeHollowCircle(GFX* gfx_p, int x, int y, int radius);
 
 void GFX_drawLine(GFX* gfx_p, int x1, int x2, int y1, int y2);
 
+// Fills the rectangle from (x1, y1) to (x2, y2), inclusive, with the
+// foreground color as a single LCD window; the part off the screen is dropped
+void GFX_fillRect(GFX* gfx_p, int x1, int y1, int x2, int y2);
+
+// Axis-aligned lines, which skip grlib's line setup and go straight to the
+// LCD driver's horizontal and vertical line fills
+void GFX_drawLineH(GFX* gfx_p, int x1, int x2, int y);
+void GFX_drawLineV(GFX* gfx_p, int x, int y1, int y2);
+
+// Draws a grid of radius-1 dots, matching GFX_drawSolidCircle(..., 1), at
+// every combination of the given screen columns and rows. Each row of dots is
+// sent as one draw window, so the background between its dots is repainted
+// too. The columns have to be in increasing order at least GFX_DOT_SIZE
+// apart, and every dot has to fit on the screen; otherwise nothing is drawn.
+// The arrays are read when the grid is rendered and have to stay valid until
+// then.
+void GFX_drawDotGrid(GFX* gfx_p, const int* dotX, int numX, const int* dotY, int numY);
+
+// Draws an image with its top-left corner at pixel (x, y). The image has to
+// fit on the screen; one that does not is not drawn.
+void GFX_drawImage(GFX* gfx_p, const GFXImage* image_p, int x, int y);
+
+// Sets up a sprite of the given size and mask, which starts out hidden. The
+// sprite is used by reference until it is hidden again.
+GFXSprite GFX_constructSprite(uint8_t width, uint8_t height, const uint8_t* mask, uint32_t color,
+                              GFXSpriteCapture capture, void* owner_p);
+
+// Shows the sprite with its top-left corner at (x, y), first putting back
+// what was under it if it was already shown. Only the sprite's old and new
+// rectangles are drawn. It has to fit on the screen; if it does not, it is
+// left where it was.
+void GFX_showSprite(GFX* gfx_p, GFXSprite* sprite_p, int x, int y);
+void GFX_hideSprite(GFX* gfx_p, GFXSprite* sprite_p);
+
+// Save-unders are queued like any other draw call. A restore puts the pixels
+// back only if the save worked and the screen has not been cleared or
+// replaced since; GFX_restoreUnder() returns false when that is already known
+// not to be the case, and the screen then has to be drawn again.
+bool GFX_canSaveUnder(void);
+void GFX_saveUnder(GFX* gfx_p, GFXSaveUnder* area_p, uint16_t* pixels, int x0, int y0, int x1, int y1);
+bool GFX_restoreUnder(GFX* gfx_p, GFXSaveUnder* area_p);
+
+// Returns the panel-native value of a 24-bit RGB color
+uint16_t GFX_nativeColor(GFX* gfx_p, uint32_t color);
+
+// Display lists for static screens. Everything drawn between
+// GFX_startRecording() and GFX_stopRecording() is also recorded into the list
+// as the panel operations it produced. A list should start with GFX_clear(),
+// because GFX_replay() repaints the whole screen from it without any grlib
+// work. GFX_replay() returns false, and draws nothing, while the list is empty.
+void GFX_startRecording(GFX* gfx_p, Crystalfontz128x128_DisplayList* list_p);
+bool GFX_stopRecording(GFX* gfx_p);
+bool GFX_replay(GFX* gfx_p, const Crystalfontz128x128_DisplayList* list_p);
+
 #endif /* HAL_GRAPHICS_H_ */
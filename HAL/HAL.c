@@ -18,6 +18,11 @@ HAL HAL_construct() {
   // The API object which will be returned at the end of construction
   HAL hal;
 
+  // Construct the GFX module first. This only starts the LCD power-up
+  // sequence; the panel wakes up while the other peripherals are constructed
+  // and HAL_refresh() finishes the sequence without blocking.
+  hal.gfx = GFX_construct(FG_COLOR, BG_COLOR);
+
   // Initialize all LEDs by calling their constructors with correctly-defined
   // arguments.
   hal.launchpadLED1 = LED_construct(LAUNCHPAD_LED1_PORT, LAUNCHPAD_LED1_PIN);
@@ -57,9 +62,6 @@ HAL HAL_construct() {
   // TODO: Call UART_SetBaud_Enable to achieve the above goal
   UART_SetBaud_Enable(&hal.uart, BAUD_9600);
 
-  // Construct the GFX module inside of this HAL struct
-  hal.gfx = GFX_construct(FG_COLOR, BG_COLOR);
-
   // Once we have finished building the API, return the completed struct.
   return hal;
 }
@@ -83,5 +85,9 @@ void HAL_refresh(HAL* hal) {
   Button_refresh(&hal->boosterpackS2);
   Button_refresh(&hal->boosterpackJS);
 
+  // Push whatever was drawn last cycle to the LCD (only does work when the
+  // driver renders into a shadow buffer)
+  GFX_refresh(&hal->gfx);
+
   // Not real TODO: No need to add anything for UART
 }
@@ -39,6 +39,7 @@
 #include <HAL/LcdDriver/Crystalfontz128x128_ST7735.h>
 #include <HAL/LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h>
 #include <stdint.h>
+#include <string.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include <ti/grlib/grlib.h>
 
@@ -47,67 +48,521 @@ uint16_t Lcd_ScreenWidth, Lcd_ScreenHeigth;
 uint8_t Lcd_PenSolid, Lcd_FontSolid, Lcd_FlagRead;
 uint16_t Lcd_TouchTrim;
 
+// Ping-pong staging buffers used to expand a row of palette-based pixels into
+// the panel's interface pixel format. One buffer can be filled while the other
+// is still being streamed to the LCD. There is room for one extra pixel, which
+// carries a half-filled byte from one row to the next in 12-bit mode.
+static uint8_t Lcd_LineBuffer[2][LCD_PIXEL_BYTES(LCD_HORIZONTAL_MAX + 1)];
+static uint8_t Lcd_LineBufferIndex = 0;
+
+//*****************************************************************************
+//
+//! Stores a pixel into a buffer in the panel's interface pixel format.
+//!
+//! \param pucData points to the start of the pixel buffer.
+//! \param ulIndex is the position of the pixel within the buffer.
+//! \param ulValue is the display-driver specific color of the pixel.
+//!
+//! In 16-bit mode each pixel takes two bytes, high byte first.  In 12-bit
+//! mode two pixels share three bytes, so a pixel at an odd index completes the
+//! byte started by the pixel before it; pixels have to be stored in order.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_PackPixel(uint8_t *pucData, uint32_t ulIndex,
+                                   uint16_t ulValue) {
+#if LCD_COLOR_BITS == 12
+  pucData += ulIndex + (ulIndex >> 1);
+  if (ulIndex & 1) {
+    pucData[0] = (pucData[0] & 0xF0) | ((ulValue >> 8) & 0x0F);
+    pucData[1] = ulValue;
+  } else {
+    pucData[0] = ulValue >> 4;
+    pucData[1] = ulValue << 4;
+  }
+#else
+  pucData += ulIndex * 2;
+  pucData[0] = ulValue >> 8;
+  pucData[1] = ulValue;
+#endif
+}
+
+//*****************************************************************************
+//
+// Reads back a pixel stored by Crystalfontz128x128_PackPixel().
+//
+//*****************************************************************************
+static uint16_t Crystalfontz128x128_UnpackPixel(const uint8_t *pucData,
+                                                uint32_t ulIndex) {
+#if LCD_COLOR_BITS == 12
+  pucData += ulIndex + (ulIndex >> 1);
+  if (ulIndex & 1) return ((pucData[0] & 0x0F) << 8) | pucData[1];
+  return (pucData[0] << 4) | (pucData[1] >> 4);
+#else
+  pucData += ulIndex * 2;
+  return (pucData[0] << 8) | pucData[1];
+#endif
+}
+
+// Half-filled byte carried from one streamed row to the next
+static bool Lcd_RowCarry = false;
+static uint8_t Lcd_RowCarryByte;
+
+//*****************************************************************************
+//
+// Returns a staging buffer for the next row of a window opened with CM_RAMWR,
+// along with the pixel index at which the row starts.
+//
+// In 12-bit mode a row of odd width ends halfway through a byte.  That byte is
+// held back and finished by the first pixel of the next row, since the window
+// is streamed as one continuous run of pixels.  The row then starts at the
+// second pixel of a packed pair, one byte in.
+//
+//*****************************************************************************
+static uint8_t *Crystalfontz128x128_BeginRow(uint32_t *pulIndex) {
+  uint8_t *pucLine = Lcd_LineBuffer[Lcd_LineBufferIndex];
+  Lcd_LineBufferIndex ^= 1;
+
+  *pulIndex = 0;
+  if (Lcd_RowCarry) {
+    pucLine[1] = Lcd_RowCarryByte;
+    *pulIndex = 1;
+  }
+  return pucLine;
+}
+
+//*****************************************************************************
+//
+// Streams a row filled after Crystalfontz128x128_BeginRow(), ulIndex being
+// the index one past its last pixel.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_EndRow(uint8_t *pucLine, uint32_t ulIndex,
+                                       bool bLastRow) {
+  uint32_t ulFirst = Lcd_RowCarry ? 1 : 0;
+  uint32_t ulBytes = ulIndex * LCD_COLOR_BITS / 8;
+
+  Lcd_RowCarry = (ulIndex * LCD_COLOR_BITS % 8) && !bLastRow;
+  if (Lcd_RowCarry)
+    Lcd_RowCarryByte = pucLine[ulBytes];
+  else
+    ulBytes = LCD_PIXEL_BYTES(ulIndex);
+
+  HAL_LCD_startBuffer(pucLine + ulFirst, ulBytes - ulFirst);
+}
+
+#if LCD_USE_SHADOW_BUFFER
+//*****************************************************************************
+//
+// RAM shadow of the panel. Drawing primitives only update this buffer and
+// record which rectangles changed; Crystalfontz128x128_FlushDirty() later
+// streams just those rectangles to the LCD, one draw window per rectangle.
+//
+//*****************************************************************************
+#define LCD_SHADOW_COLORS (1 << LCD_SHADOW_BPP)
+#define LCD_SHADOW_PIXELS (LCD_HORIZONTAL_MAX * LCD_VERTICAL_MAX)
+
+static uint8_t Lcd_ShadowBuffer[LCD_SHADOW_PIXELS * LCD_SHADOW_BPP / 8];
+static uint16_t Lcd_ShadowPalette[LCD_SHADOW_COLORS];
+static uint16_t Lcd_ShadowNumColors;
+static uint8_t Lcd_ShadowLastIndex;
+
+static Graphics_Rectangle Lcd_DirtyRects[LCD_SHADOW_MAX_DIRTY_RECTS];
+static uint8_t Lcd_NumDirtyRects;
+
+// Bounding box of the pixels changed by the primitive being drawn
+static int16_t Lcd_ChangeXMin, Lcd_ChangeYMin, Lcd_ChangeXMax, Lcd_ChangeYMax;
+
+//*****************************************************************************
+//
+// Returns the palette index of a native color, allocating a new palette entry
+// the first time a color is used. Once the palette is full the closest
+// existing entry is used instead.
+//
+//*****************************************************************************
+static uint8_t Crystalfontz128x128_ShadowColorIndex(uint16_t ulValue) {
+  if (Lcd_ShadowPalette[Lcd_ShadowLastIndex] == ulValue)
+    return Lcd_ShadowLastIndex;
+
+  uint16_t i;
+  for (i = 0; i < Lcd_ShadowNumColors; i++) {
+    if (Lcd_ShadowPalette[i] == ulValue) return Lcd_ShadowLastIndex = i;
+  }
+
+  if (Lcd_ShadowNumColors < LCD_SHADOW_COLORS) {
+    Lcd_ShadowPalette[Lcd_ShadowNumColors] = ulValue;
+    return Lcd_ShadowLastIndex = Lcd_ShadowNumColors++;
+  }
+
+  uint32_t bestDistance = 0xFFFFFFFF;
+  uint8_t best = 0;
+  for (i = 0; i < Lcd_ShadowNumColors; i++) {
+#if LCD_COLOR_BITS == 12
+    int32_t dr = (int32_t)(ulValue >> 8) - (Lcd_ShadowPalette[i] >> 8);
+    int32_t dg = (int32_t)((ulValue >> 4) & 0x0F) -
+                 ((Lcd_ShadowPalette[i] >> 4) & 0x0F);
+    int32_t db = (int32_t)(ulValue & 0x0F) - (Lcd_ShadowPalette[i] & 0x0F);
+    uint32_t distance = dr * dr + dg * dg + db * db;
+#else
+    int32_t dr = (int32_t)(ulValue >> 11) - (Lcd_ShadowPalette[i] >> 11);
+    int32_t dg = (int32_t)((ulValue >> 5) & 0x3F) -
+                 ((Lcd_ShadowPalette[i] >> 5) & 0x3F);
+    int32_t db = (int32_t)(ulValue & 0x1F) - (Lcd_ShadowPalette[i] & 0x1F);
+    uint32_t distance = 4 * dr * dr + dg * dg + 4 * db * db;
+#endif
+    if (distance < bestDistance) {
+      bestDistance = distance;
+      best = i;
+    }
+  }
+  return best;
+}
+
+static uint8_t Crystalfontz128x128_ShadowGet(int16_t lX, int16_t lY) {
+  uint16_t offset = lY * LCD_HORIZONTAL_MAX + lX;
+#if LCD_SHADOW_BPP == 8
+  return Lcd_ShadowBuffer[offset];
+#else
+  uint8_t packed = Lcd_ShadowBuffer[offset >> 1];
+  return (offset & 1) ? (packed & 0x0F) : (packed >> 4);
+#endif
+}
+
+static void Crystalfontz128x128_ShadowBeginChange(void) {
+  Lcd_ChangeXMin = LCD_HORIZONTAL_MAX;
+  Lcd_ChangeYMin = LCD_VERTICAL_MAX;
+  Lcd_ChangeXMax = -1;
+  Lcd_ChangeYMax = -1;
+}
+
+//*****************************************************************************
+//
+// Writes one palette index into the shadow, growing the changed bounding box
+// only if the stored value actually differs.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_ShadowPut(int16_t lX, int16_t lY,
+                                          uint8_t index) {
+  uint16_t offset = lY * LCD_HORIZONTAL_MAX + lX;
+#if LCD_SHADOW_BPP == 8
+  if (Lcd_ShadowBuffer[offset] == index) return;
+  Lcd_ShadowBuffer[offset] = index;
+#else
+  uint8_t packed = Lcd_ShadowBuffer[offset >> 1];
+  uint8_t updated = (offset & 1) ? ((packed & 0xF0) | index)
+                                 : ((packed & 0x0F) | (index << 4));
+  if (updated == packed) return;
+  Lcd_ShadowBuffer[offset >> 1] = updated;
+#endif
+
+  if (lX < Lcd_ChangeXMin) Lcd_ChangeXMin = lX;
+  if (lX > Lcd_ChangeXMax) Lcd_ChangeXMax = lX;
+  if (lY < Lcd_ChangeYMin) Lcd_ChangeYMin = lY;
+  if (lY > Lcd_ChangeYMax) Lcd_ChangeYMax = lY;
+}
+
+static uint32_t Crystalfontz128x128_RectArea(const Graphics_Rectangle *pRect) {
+  return (uint32_t)(pRect->sXMax - pRect->sXMin + 1) *
+         (pRect->sYMax - pRect->sYMin + 1);
+}
+
+static void Crystalfontz128x128_RectUnion(Graphics_Rectangle *pDst,
+                                          const Graphics_Rectangle *pSrc) {
+  if (pSrc->sXMin < pDst->sXMin) pDst->sXMin = pSrc->sXMin;
+  if (pSrc->sYMin < pDst->sYMin) pDst->sYMin = pSrc->sYMin;
+  if (pSrc->sXMax > pDst->sXMax) pDst->sXMax = pSrc->sXMax;
+  if (pSrc->sYMax > pDst->sYMax) pDst->sYMax = pSrc->sYMax;
+}
+
+//*****************************************************************************
+//
+// Adds a rectangle to the dirty list. Rectangles that overlap or touch are
+// merged; when the list is full the new rectangle is merged into whichever
+// existing one grows the least.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_AddDirtyRect(Graphics_Rectangle rect) {
+  uint8_t i = 0;
+
+  while (i < Lcd_NumDirtyRects) {
+    Graphics_Rectangle *pDirty = &Lcd_DirtyRects[i];
+
+    if (rect.sXMin <= pDirty->sXMax + 1 && pDirty->sXMin <= rect.sXMax + 1 &&
+        rect.sYMin <= pDirty->sYMax + 1 && pDirty->sYMin <= rect.sYMax + 1) {
+      // Absorb the existing rectangle and start over, since the union may now
+      // touch rectangles that were already checked
+      Crystalfontz128x128_RectUnion(&rect, pDirty);
+      Lcd_DirtyRects[i] = Lcd_DirtyRects[--Lcd_NumDirtyRects];
+      i = 0;
+    } else {
+      i++;
+    }
+  }
+
+  if (Lcd_NumDirtyRects < LCD_SHADOW_MAX_DIRTY_RECTS) {
+    Lcd_DirtyRects[Lcd_NumDirtyRects++] = rect;
+    return;
+  }
+
+  uint32_t bestGrowth = 0xFFFFFFFF;
+  uint8_t best = 0;
+  for (i = 0; i < Lcd_NumDirtyRects; i++) {
+    Graphics_Rectangle merged = Lcd_DirtyRects[i];
+    Crystalfontz128x128_RectUnion(&merged, &rect);
+    uint32_t growth = Crystalfontz128x128_RectArea(&merged) -
+                      Crystalfontz128x128_RectArea(&Lcd_DirtyRects[i]);
+    if (growth < bestGrowth) {
+      bestGrowth = growth;
+      best = i;
+    }
+  }
+  Crystalfontz128x128_RectUnion(&Lcd_DirtyRects[best], &rect);
+}
+
+static void Crystalfontz128x128_ShadowEndChange(void) {
+  if (Lcd_ChangeXMax < 0) return;
+
+  Graphics_Rectangle rect = {Lcd_ChangeXMin, Lcd_ChangeYMin, Lcd_ChangeXMax,
+                             Lcd_ChangeYMax};
+  Crystalfontz128x128_AddDirtyRect(rect);
+}
+
+//*****************************************************************************
+//
+// Fills an inclusive rectangle of the shadow with a single native color.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_ShadowFill(int16_t x0, int16_t y0, int16_t x1,
+                                           int16_t y1, uint16_t ulValue) {
+  uint8_t index = Crystalfontz128x128_ShadowColorIndex(ulValue);
+  int16_t x, y;
+
+  Crystalfontz128x128_ShadowBeginChange();
+  for (y = y0; y <= y1; y++) {
+    for (x = x0; x <= x1; x++) Crystalfontz128x128_ShadowPut(x, y, index);
+  }
+  Crystalfontz128x128_ShadowEndChange();
+}
+
+//*****************************************************************************
+//
+// Writes a row of pixels, given in the interface pixel format starting at
+// pixel ulIndex of pucData, into the shadow.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_ShadowWriteRow(int16_t lX, int16_t lY,
+                                               const uint8_t *pucData,
+                                               uint32_t ulIndex,
+                                               int16_t lCount) {
+  Crystalfontz128x128_ShadowBeginChange();
+  while (lCount--) {
+    uint16_t ulValue = Crystalfontz128x128_UnpackPixel(pucData, ulIndex++);
+    Crystalfontz128x128_ShadowPut(
+        lX++, lY, Crystalfontz128x128_ShadowColorIndex(ulValue));
+  }
+  Crystalfontz128x128_ShadowEndChange();
+}
+
+//*****************************************************************************
+//
+// Resets the shadow to a single color which is already shown on the panel.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_ShadowReset(uint16_t ulValue) {
+  uint16_t i;
+
+  Lcd_ShadowPalette[0] = ulValue;
+  Lcd_ShadowNumColors = 1;
+  Lcd_ShadowLastIndex = 0;
+  Lcd_NumDirtyRects = 0;
+
+  for (i = 0; i < sizeof(Lcd_ShadowBuffer); i++) Lcd_ShadowBuffer[i] = 0;
+}
+
+//*****************************************************************************
+//
+// Marks the whole screen as needing to be pushed on the next flush.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_ShadowMarkAllDirty(void) {
+  Graphics_Rectangle rect = {0, 0, LCD_HORIZONTAL_MAX - 1,
+                             LCD_VERTICAL_MAX - 1};
+  Lcd_NumDirtyRects = 0;
+  Crystalfontz128x128_AddDirtyRect(rect);
+}
+
+//*****************************************************************************
+//
+// Drops palette entries which are no longer referenced by any pixel, so that
+// long-running applications do not exhaust a 4bpp palette.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_ShadowCompactPalette(void) {
+  static uint8_t used[LCD_SHADOW_COLORS];
+  static uint8_t remap[LCD_SHADOW_COLORS];
+  uint16_t i;
+
+  for (i = 0; i < LCD_SHADOW_COLORS; i++) used[i] = 0;
+  int16_t x, y;
+
+  for (y = 0; y < LCD_VERTICAL_MAX; y++) {
+    for (x = 0; x < LCD_HORIZONTAL_MAX; x++)
+      used[Crystalfontz128x128_ShadowGet(x, y)] = 1;
+  }
+
+  uint16_t numColors = 0;
+  for (i = 0; i < Lcd_ShadowNumColors; i++) {
+    if (used[i]) {
+      remap[i] = numColors;
+      Lcd_ShadowPalette[numColors++] = Lcd_ShadowPalette[i];
+    }
+  }
+
+  if (numColors == Lcd_ShadowNumColors) return;
+
+  for (i = 0; i < sizeof(Lcd_ShadowBuffer); i++) {
+#if LCD_SHADOW_BPP == 8
+    Lcd_ShadowBuffer[i] = remap[Lcd_ShadowBuffer[i]];
+#else
+    uint8_t packed = Lcd_ShadowBuffer[i];
+    Lcd_ShadowBuffer[i] = (remap[packed >> 4] << 4) | remap[packed & 0x0F];
+#endif
+  }
+  Lcd_ShadowNumColors = numColors;
+  Lcd_ShadowLastIndex = 0;
+}
+#endif
+
+// Waits between the steps of the power-up sequence, in microseconds
+#define LCD_RESET_HOLD_US 50
+#define LCD_RESET_RECOVERY_US 120
+#define LCD_SLEEP_OUT_US 200
+#define LCD_COLMOD_US 10
+
+// Vertical scroll area, in frame memory rows, set by
+// Crystalfontz128x128_SetScrollArea()
+static uint16_t Lcd_ScrollFirstRow, Lcd_ScrollNumRows;
+static bool Lcd_ScrollReversed;
+
+// Progress through the power-up sequence driven by
+// Crystalfontz128x128_InitStep()
+static uint8_t Lcd_InitStep = 0;
+
 //*****************************************************************************
 //
 //! Initializes the display driver.
 //!
 //! This function initializes the ST7735 display controller on the panel,
-//! preparing it to display data.
+//! preparing it to display data, and then turns the display on.  It blocks for
+//! the whole power-up sequence; use Crystalfontz128x128_InitStep() to run the
+//! same sequence without blocking.  The panel memory is not cleared, so the
+//! caller is expected to draw a full frame before anything is shown.
 //!
 //! \return None.
 //
 //*****************************************************************************
 void Crystalfontz128x128_Init(void) {
-  HAL_LCD_PortInit();
-  HAL_LCD_SpiInit();
+  uint32_t wait_us;
+
+  Lcd_InitStep = 0;
+  while ((wait_us = Crystalfontz128x128_InitStep()) != 0) {
+    while (wait_us--) HAL_LCD_delay(1);
+  }
+
+  Crystalfontz128x128_DisplayOn();
+}
+
+//*****************************************************************************
+//
+//! Performs the next step of the display power-up sequence.
+//!
+//! The ST7735 needs to be held in reset, given time to recover from reset and
+//! given time to leave sleep mode before it accepts configuration.  Rather
+//! than spinning through those waits, this function performs one step and
+//! returns how long the caller must wait before calling it again, so the
+//! waits can be spent bringing up other peripherals.  Once it returns 0 the
+//! controller is configured and ready for pixel data, with the display still
+//! off; call Crystalfontz128x128_DisplayOn() once the first frame is drawn.
+//!
+//! \return the number of microseconds to wait before the next step, or 0 when
+//! the sequence is complete.
+//
+//*****************************************************************************
+uint32_t Crystalfontz128x128_InitStep(void) {
+  switch (Lcd_InitStep++) {
+    case 0:
+      HAL_LCD_PortInit();
+      HAL_LCD_SpiInit();
+      HAL_LCD_DmaInit();
 
-  GPIO_setOutputLowOnPin(LCD_RST_PORT, LCD_RST_PIN);
-  HAL_LCD_delay(50);
-  GPIO_setOutputHighOnPin(LCD_RST_PORT, LCD_RST_PIN);
-  HAL_LCD_delay(120);
+      GPIO_setOutputLowOnPin(LCD_RST_PORT, LCD_RST_PIN);
+      return LCD_RESET_HOLD_US;
+
+    case 1:
+      GPIO_setOutputHighOnPin(LCD_RST_PORT, LCD_RST_PIN);
+      return LCD_RESET_RECOVERY_US;
 
-  HAL_LCD_writeCommand(CM_SLPOUT);
-  HAL_LCD_delay(200);
+    case 2:
+      HAL_LCD_writeCommand(CM_SLPOUT);
+      return LCD_SLEEP_OUT_US;
 
-  HAL_LCD_writeCommand(CM_GAMSET);
-  HAL_LCD_writeData(0x04);
+    case 3:
+      HAL_LCD_writeCommand(CM_GAMSET);
+      HAL_LCD_writeData(0x04);
 
-  HAL_LCD_writeCommand(CM_SETPWCTR);
-  HAL_LCD_writeData(0x0A);
-  HAL_LCD_writeData(0x14);
+      HAL_LCD_writeCommand(CM_SETPWCTR);
+      HAL_LCD_writeData(0x0A);
+      HAL_LCD_writeData(0x14);
 
-  HAL_LCD_writeCommand(CM_SETSTBA);
-  HAL_LCD_writeData(0x0A);
-  HAL_LCD_writeData(0x00);
+      HAL_LCD_writeCommand(CM_SETSTBA);
+      HAL_LCD_writeData(0x0A);
+      HAL_LCD_writeData(0x00);
 
-  HAL_LCD_writeCommand(CM_COLMOD);
-  HAL_LCD_writeData(0x05);
-  HAL_LCD_delay(10);
+      HAL_LCD_writeCommand(CM_COLMOD);
+#if LCD_COLOR_BITS == 12
+      HAL_LCD_writeData(CM_COLMOD_12BIT);
+#else
+      HAL_LCD_writeData(CM_COLMOD_16BIT);
+#endif
+      return LCD_COLMOD_US;
 
-  HAL_LCD_writeCommand(CM_MADCTL);
-  HAL_LCD_writeData(CM_MADCTL_BGR);
+    case 4:
+      HAL_LCD_writeCommand(CM_MADCTL);
+      HAL_LCD_writeData(CM_MADCTL_BGR);
 
-  HAL_LCD_writeCommand(CM_NORON);
+      HAL_LCD_writeCommand(CM_NORON);
 
-  Lcd_ScreenWidth = LCD_VERTICAL_MAX;
-  Lcd_ScreenHeigth = LCD_HORIZONTAL_MAX;
-  Lcd_PenSolid = 0;
-  Lcd_FontSolid = 1;
-  Lcd_FlagRead = 0;
-  Lcd_TouchTrim = 0;
+      Lcd_ScreenWidth = LCD_VERTICAL_MAX;
+      Lcd_ScreenHeigth = LCD_HORIZONTAL_MAX;
+      Lcd_PenSolid = 0;
+      Lcd_FontSolid = 1;
+      Lcd_FlagRead = 0;
+      Lcd_TouchTrim = 0;
 
-  Crystalfontz128x128_SetDrawFrame(0, 0, 127, 127);
-  HAL_LCD_writeCommand(CM_RAMWR);
-  int i;
-  for (i = 0; i < 16384; i++) {
-    HAL_LCD_writeData(0xFF);
-    HAL_LCD_writeData(0xFF);
-  }
+#if LCD_USE_SHADOW_BUFFER
+      // The panel memory holds garbage, so the first flush must push the
+      // whole screen regardless of what is drawn into the shadow
+      Crystalfontz128x128_ShadowReset(0x0000);
+      Crystalfontz128x128_ShadowMarkAllDirty();
+#endif
+      return 0;
 
-  HAL_LCD_delay(10);
-  HAL_LCD_writeCommand(CM_DISPON);
+    default:
+      Lcd_InitStep--;
+      return 0;
+  }
 }
 
+//*****************************************************************************
+//
+//! Turns the display on.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_DisplayOn(void) { HAL_LCD_writeCommand(CM_DISPON); }
+
 void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1,
                                       uint16_t y1) {
   switch (Lcd_Orientation) {
@@ -139,17 +594,824 @@ void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1,
       break;
   }
 
+  //
+  // Send each address pair as one burst rather than byte by byte. The
+  // buffers live on the stack, so they are written by the CPU before the
+  // calls return and never handed to DMA.
+  //
+  uint8_t pucColumns[4] = {x0 >> 8, x0, x1 >> 8, x1};
+  uint8_t pucRows[4] = {y0 >> 8, y0, y1 >> 8, y1};
+
   HAL_LCD_writeCommand(CM_CASET);
-  HAL_LCD_writeData((uint8_t)(x0 >> 8));
-  HAL_LCD_writeData((uint8_t)(x0));
-  HAL_LCD_writeData((uint8_t)(x1 >> 8));
-  HAL_LCD_writeData((uint8_t)(x1));
+  HAL_LCD_writeBytes(pucColumns, sizeof(pucColumns));
 
   HAL_LCD_writeCommand(CM_RASET);
-  HAL_LCD_writeData((uint8_t)(y0 >> 8));
-  HAL_LCD_writeData((uint8_t)(y0));
-  HAL_LCD_writeData((uint8_t)(y1 >> 8));
-  HAL_LCD_writeData((uint8_t)(y1));
+  HAL_LCD_writeBytes(pucRows, sizeof(pucRows));
+}
+
+//*****************************************************************************
+//
+//! Reports whether pixel data is still being streamed to the panel.
+//!
+//! Fills and row transfers return as soon as they have been handed to the
+//! DMA controller, so the super-loop can keep running while the LCD updates.
+//!
+//! \return true if a transfer is still in progress, false otherwise.
+//
+//*****************************************************************************
+bool Crystalfontz128x128_IsBusy(void) { return HAL_LCD_isBusy(); }
+
+//*****************************************************************************
+//
+//! Waits for all pending pixel transfers to complete.
+//!
+//! This function blocks until every pixel handed to the driver has been
+//! shifted out to the panel.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_WaitForCompletion(void) { HAL_LCD_waitForCompletion(); }
+
+//*****************************************************************************
+//
+//! Pushes every region of the shadow buffer which changed since the last
+//! flush to the panel.
+//!
+//! Each dirty rectangle is sent through a single draw window, row by row, so
+//! that overlapping draws reach the panel only once. The last row may still be
+//! streaming when this function returns. Without a shadow buffer this is a no
+//! operation, since every primitive already writes straight to the panel.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_FlushDirty(void) {
+#if LCD_USE_SHADOW_BUFFER
+  uint8_t i;
+
+  for (i = 0; i < Lcd_NumDirtyRects; i++) {
+    const Graphics_Rectangle *pRect = &Lcd_DirtyRects[i];
+    int16_t x, y;
+
+    Crystalfontz128x128_SetDrawFrame(pRect->sXMin, pRect->sYMin, pRect->sXMax,
+                                     pRect->sYMax);
+    HAL_LCD_writeCommand(CM_RAMWR);
+
+    for (y = pRect->sYMin; y <= pRect->sYMax; y++) {
+      uint32_t ulIndex;
+      uint8_t *pucLine = Crystalfontz128x128_BeginRow(&ulIndex);
+
+      for (x = pRect->sXMin; x <= pRect->sXMax; x++) {
+        uint16_t ulValue =
+            Lcd_ShadowPalette[Crystalfontz128x128_ShadowGet(x, y)];
+        Crystalfontz128x128_PackPixel(pucLine, ulIndex++, ulValue);
+      }
+
+      Crystalfontz128x128_EndRow(pucLine, ulIndex, y == pRect->sYMax);
+    }
+  }
+
+  Lcd_NumDirtyRects = 0;
+
+  if (Lcd_ShadowNumColors == LCD_SHADOW_COLORS)
+    Crystalfontz128x128_ShadowCompactPalette();
+#endif
+}
+
+//*****************************************************************************
+//
+//! Defines the area of the screen moved by hardware vertical scrolling.
+//!
+//! \param top is the first screen row of the scroll area.
+//! \param bottom is the last screen row of the scroll area.
+//!
+//! The controller scrolls along its frame memory rows, which only line up
+//! with screen rows in the \b LCD_ORIENTATION_UP and \b LCD_ORIENTATION_DOWN
+//! orientations.  Rows outside the area stay fixed.  The scroll offset is
+//! reset to zero.
+//!
+//! \return true if the area was set, false if the current orientation does
+//! not support vertical scrolling.
+//
+//*****************************************************************************
+bool Crystalfontz128x128_SetScrollArea(uint16_t top, uint16_t bottom) {
+  uint16_t firstRow;
+
+  switch (Lcd_Orientation) {
+    case LCD_ORIENTATION_UP:
+      // MY is set, so screen rows run backwards through frame memory
+      firstRow = (LCD_FRAME_MEMORY_ROWS - 1) - (bottom + 3);
+      Lcd_ScrollReversed = true;
+      break;
+    case LCD_ORIENTATION_DOWN:
+      firstRow = top + 1;
+      Lcd_ScrollReversed = false;
+      break;
+    default:
+      return false;
+  }
+
+  Lcd_ScrollFirstRow = firstRow;
+  Lcd_ScrollNumRows = bottom - top + 1;
+  uint16_t bottomRows =
+      LCD_FRAME_MEMORY_ROWS - Lcd_ScrollFirstRow - Lcd_ScrollNumRows;
+
+  HAL_LCD_writeCommand(CM_SCRLAR);
+  HAL_LCD_writeData((uint8_t)(Lcd_ScrollFirstRow >> 8));
+  HAL_LCD_writeData((uint8_t)(Lcd_ScrollFirstRow));
+  HAL_LCD_writeData((uint8_t)(Lcd_ScrollNumRows >> 8));
+  HAL_LCD_writeData((uint8_t)(Lcd_ScrollNumRows));
+  HAL_LCD_writeData((uint8_t)(bottomRows >> 8));
+  HAL_LCD_writeData((uint8_t)(bottomRows));
+
+  Crystalfontz128x128_SetScrollOffset(0);
+  return true;
+}
+
+//*****************************************************************************
+//
+//! Scrolls the contents of the scroll area.
+//!
+//! \param offset is the number of rows to scroll by.
+//!
+//! After this call the first screen row of the scroll area shows what was
+//! drawn at row (top + offset), wrapping around within the area, so drawing
+//! coordinates are unaffected by scrolling.  Only two bytes of data are sent,
+//! regardless of how much of the screen moves.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_SetScrollOffset(uint16_t offset) {
+  if (Lcd_ScrollNumRows == 0) return;
+
+  offset %= Lcd_ScrollNumRows;
+  if (Lcd_ScrollReversed && offset != 0) offset = Lcd_ScrollNumRows - offset;
+
+  uint16_t startRow = Lcd_ScrollFirstRow + offset;
+
+  HAL_LCD_writeCommand(CM_VSCSAD);
+  HAL_LCD_writeData((uint8_t)(startRow >> 8));
+  HAL_LCD_writeData((uint8_t)(startRow));
+}
+
+//*****************************************************************************
+//
+//! Leaves vertical scroll mode.
+//!
+//! The scroll offset returns to zero and the controller goes back to normal
+//! display mode.  Anything drawn while scrolled will appear rotated within the
+//! old scroll area, so it should be redrawn.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_StopScroll(void) {
+  Crystalfontz128x128_SetScrollOffset(0);
+  Lcd_ScrollNumRows = 0;
+  HAL_LCD_writeCommand(CM_NORON);
+}
+
+//*****************************************************************************
+//
+// Display lists.  While a list is being recorded every drawing primitive also
+// appends the panel operation it performed to the list, as a byte stream of
+//
+//   [op][x0][y0][x1][y1] followed by
+//     LCD_DL_FILL:   [color hi][color lo]
+//     LCD_DL_BITMAP: [color 0 hi][color 0 lo][color 1 hi][color 1 lo] and one
+//                    bit per pixel, row by row, MSB first
+//     LCD_DL_PIXELS: the pixels in the interface pixel format
+//
+// with inclusive screen coordinates and panel-native colors.  Blocks of at
+// most two colors, such as glyphs, are stored as bitmaps.
+//
+//*****************************************************************************
+#define LCD_DL_FILL 0
+#define LCD_DL_BITMAP 1
+#define LCD_DL_PIXELS 2
+#define LCD_DL_HEADER_BYTES 5
+
+// List being recorded, or NULL
+static Crystalfontz128x128_DisplayList *Lcd_Recording = NULL;
+
+static uint32_t Crystalfontz128x128_OpPixels(const uint8_t *pucOp) {
+  return (uint32_t)(pucOp[3] - pucOp[1] + 1) * (pucOp[4] - pucOp[2] + 1);
+}
+
+static uint32_t Crystalfontz128x128_OpBytes(const uint8_t *pucOp) {
+  switch (pucOp[0]) {
+    case LCD_DL_FILL:
+      return LCD_DL_HEADER_BYTES + 2;
+    case LCD_DL_BITMAP:
+      return LCD_DL_HEADER_BYTES + 4 +
+             (Crystalfontz128x128_OpPixels(pucOp) + 7) / 8;
+    default:
+      return LCD_DL_HEADER_BYTES +
+             LCD_PIXEL_BYTES(Crystalfontz128x128_OpPixels(pucOp));
+  }
+}
+
+//*****************************************************************************
+//
+// Returns the color of the ulIndex-th pixel of a bitmap or pixel operation.
+//
+//*****************************************************************************
+static uint16_t Crystalfontz128x128_OpPixel(const uint8_t *pucOp,
+                                            uint32_t ulIndex) {
+  const uint8_t *pucPayload = pucOp + LCD_DL_HEADER_BYTES;
+
+  if (pucOp[0] == LCD_DL_PIXELS)
+    return Crystalfontz128x128_UnpackPixel(pucPayload, ulIndex);
+
+  if (pucPayload[4 + ulIndex / 8] & (0x80 >> (ulIndex % 8)))
+    pucPayload += 2;
+  return (pucPayload[0] << 8) | pucPayload[1];
+}
+
+//*****************************************************************************
+//
+// Appends an operation header to the list being recorded and returns where
+// its payload goes, or NULL if nothing is recorded or the list is full.
+//
+//*****************************************************************************
+static uint8_t *Crystalfontz128x128_RecordOp(uint8_t ucOp, int16_t x0,
+                                             int16_t y0, int16_t x1,
+                                             int16_t y1, uint32_t ulPayload) {
+  Crystalfontz128x128_DisplayList *pList = Lcd_Recording;
+
+  if (pList == NULL || pList->bOverflow) return NULL;
+  if (pList->ulLength + LCD_DL_HEADER_BYTES + ulPayload > pList->ulSize) {
+    pList->bOverflow = true;
+    return NULL;
+  }
+
+  uint8_t *pucOp = pList->pucData + pList->ulLength;
+  pucOp[0] = ucOp;
+  pucOp[1] = x0;
+  pucOp[2] = y0;
+  pucOp[3] = x1;
+  pucOp[4] = y1;
+  pList->ulLength += LCD_DL_HEADER_BYTES + ulPayload;
+
+  return pucOp + LCD_DL_HEADER_BYTES;
+}
+
+//*****************************************************************************
+//
+// Records a rectangle filled with a single color.  Operations recorded
+// earlier which lie entirely inside the rectangle would only be painted over
+// on replay, so they are dropped.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_RecordFill(int16_t x0, int16_t y0, int16_t x1,
+                                           int16_t y1, uint16_t ulValue) {
+  Crystalfontz128x128_DisplayList *pList = Lcd_Recording;
+  if (pList == NULL || pList->bOverflow) return;
+
+  uint32_t ulRead = 0, ulWrite = 0;
+  while (ulRead < pList->ulLength) {
+    uint8_t *pucOp = pList->pucData + ulRead;
+    uint32_t ulBytes = Crystalfontz128x128_OpBytes(pucOp);
+
+    if (pucOp[1] < x0 || pucOp[2] < y0 || pucOp[3] > x1 || pucOp[4] > y1) {
+      if (ulWrite != ulRead)
+        memmove(pList->pucData + ulWrite, pucOp, ulBytes);
+      ulWrite += ulBytes;
+    }
+    ulRead += ulBytes;
+  }
+  pList->ulLength = ulWrite;
+
+  uint8_t *pucPayload =
+      Crystalfontz128x128_RecordOp(LCD_DL_FILL, x0, y0, x1, y1, 2);
+  if (pucPayload == NULL) return;
+
+  pucPayload[0] = ulValue >> 8;
+  pucPayload[1] = ulValue;
+}
+
+//*****************************************************************************
+//
+// Records a rectangle of pixels given in the interface pixel format, starting
+// at pixel ulIndex of pucData.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_RecordPixels(int16_t x0, int16_t y0,
+                                             int16_t x1, int16_t y1,
+                                             const uint8_t *pucData,
+                                             uint32_t ulIndex) {
+  if (Lcd_Recording == NULL) return;
+
+  uint32_t ulCount = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+  uint16_t usColor0 = Crystalfontz128x128_UnpackPixel(pucData, ulIndex);
+  uint16_t usColor1 = usColor0;
+  bool bTwoColors = true;
+  uint32_t i;
+
+  for (i = 1; i < ulCount && bTwoColors; i++) {
+    uint16_t ulValue = Crystalfontz128x128_UnpackPixel(pucData, ulIndex + i);
+    if (ulValue == usColor0 || ulValue == usColor1) continue;
+
+    if (usColor1 == usColor0)
+      usColor1 = ulValue;
+    else
+      bTwoColors = false;
+  }
+
+  uint8_t *pucPayload;
+
+  if (!bTwoColors) {
+    pucPayload = Crystalfontz128x128_RecordOp(LCD_DL_PIXELS, x0, y0, x1, y1,
+                                              LCD_PIXEL_BYTES(ulCount));
+    if (pucPayload == NULL) return;
+
+    for (i = 0; i < ulCount; i++) {
+      Crystalfontz128x128_PackPixel(
+          pucPayload, i,
+          Crystalfontz128x128_UnpackPixel(pucData, ulIndex + i));
+    }
+    return;
+  }
+
+  //
+  // Single-color blocks are kept as bitmaps too, rather than fills, so that a
+  // line of text stays one run of bitmaps that replays through one window.
+  //
+  pucPayload = Crystalfontz128x128_RecordOp(LCD_DL_BITMAP, x0, y0, x1, y1,
+                                            4 + (ulCount + 7) / 8);
+  if (pucPayload == NULL) return;
+
+  pucPayload[0] = usColor0 >> 8;
+  pucPayload[1] = usColor0;
+  pucPayload[2] = usColor1 >> 8;
+  pucPayload[3] = usColor1;
+  memset(pucPayload + 4, 0, (ulCount + 7) / 8);
+
+  for (i = 0; i < ulCount; i++) {
+    if (Crystalfontz128x128_UnpackPixel(pucData, ulIndex + i) != usColor0)
+      pucPayload[4 + i / 8] |= 0x80 >> (i % 8);
+  }
+}
+
+//*****************************************************************************
+//
+//! Starts recording drawing operations into a display list.
+//!
+//! \param pList is the list to record into.  Its pucData and ulSize members
+//! describe the storage for the list and must be set by the caller.
+//!
+//! Until Crystalfontz128x128_EndRecording() is called, every primitive drawn
+//! through this driver is also appended to the list, after being reduced to
+//! the rectangles and pixels that actually reach the panel.  Drawing still
+//! takes place as usual.  Only one list can be recorded at a time.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_BeginRecording(Crystalfontz128x128_DisplayList *pList) {
+  pList->ulLength = 0;
+  pList->bOverflow = false;
+  Lcd_Recording = pList;
+}
+
+//*****************************************************************************
+//
+//! Stops recording the current display list.
+//!
+//! A list which ran out of space is emptied, since replaying part of a screen
+//! would be wrong.
+//!
+//! \return true if the list was recorded completely, false otherwise.
+//
+//*****************************************************************************
+bool Crystalfontz128x128_EndRecording(void) {
+  Crystalfontz128x128_DisplayList *pList = Lcd_Recording;
+
+  Lcd_Recording = NULL;
+  if (pList == NULL) return false;
+
+  if (pList->bOverflow) pList->ulLength = 0;
+  return pList->ulLength > 0;
+}
+
+//*****************************************************************************
+//
+//! Replays a recorded display list.
+//!
+//! \param pucData points to the recorded operations, either the pucData of a
+//! Crystalfontz128x128_DisplayList or a copy of it kept in flash.
+//! \param ulLength is the number of bytes of recorded operations.
+//!
+//! The operations are streamed straight to the panel without any graphics
+//! library work.  Runs of bitmaps which sit side by side on the same rows,
+//! such as the glyphs of a line of text, are sent through a single draw
+//! window.  Recorded colors are in the interface pixel format of the build
+//! that recorded them, so a list kept in flash only suits that format.  With
+//! the shadow buffer enabled the list is drawn into the shadow instead.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_ReplayDisplayList(const uint8_t *pucData,
+                                           uint32_t ulLength) {
+  const uint8_t *pucEnd = pucData + ulLength;
+
+  while (pucData < pucEnd) {
+    const uint8_t *pucOp = pucData;
+    uint16_t x0 = pucOp[1], y0 = pucOp[2], x1 = pucOp[3], y1 = pucOp[4];
+    uint16_t x, y;
+
+    if (pucOp[0] == LCD_DL_FILL) {
+      uint16_t ulValue = (pucOp[5] << 8) | pucOp[6];
+      pucData += Crystalfontz128x128_OpBytes(pucOp);
+
+#if LCD_USE_SHADOW_BUFFER
+      Crystalfontz128x128_ShadowFill(x0, y0, x1, y1, ulValue);
+#else
+      Crystalfontz128x128_SetDrawFrame(x0, y0, x1, y1);
+      HAL_LCD_writeCommand(CM_RAMWR);
+      HAL_LCD_startFill(ulValue, Crystalfontz128x128_OpPixels(pucOp));
+#endif
+      continue;
+    }
+
+#if LCD_USE_SHADOW_BUFFER
+    pucData += Crystalfontz128x128_OpBytes(pucOp);
+
+    for (y = y0; y <= y1; y++) {
+      uint32_t ulIndex;
+      uint8_t *pucLine = Crystalfontz128x128_BeginRow(&ulIndex);
+      uint32_t ulPixel = (uint32_t)(y - y0) * (x1 - x0 + 1);
+
+      for (x = x0; x <= x1; x++) {
+        Crystalfontz128x128_PackPixel(
+            pucLine, ulIndex++, Crystalfontz128x128_OpPixel(pucOp, ulPixel++));
+      }
+      Crystalfontz128x128_ShadowWriteRow(x0, y, pucLine, 0, x1 - x0 + 1);
+    }
+#else
+    //
+    // Extend the window over the following operations which continue this
+    // one to the right on the same rows.
+    //
+    uint16_t numOps = 1;
+    pucData += Crystalfontz128x128_OpBytes(pucOp);
+
+    while (pucData < pucEnd && pucData[0] != LCD_DL_FILL &&
+           pucData[1] == x1 + 1 && pucData[2] == y0 && pucData[4] == y1) {
+      x1 = pucData[3];
+      numOps++;
+      pucData += Crystalfontz128x128_OpBytes(pucData);
+    }
+
+    Crystalfontz128x128_SetDrawFrame(x0, y0, x1, y1);
+    HAL_LCD_writeCommand(CM_RAMWR);
+
+    for (y = y0; y <= y1; y++) {
+      uint32_t ulIndex;
+      uint8_t *pucLine = Crystalfontz128x128_BeginRow(&ulIndex);
+      const uint8_t *pucRunOp = pucOp;
+      uint16_t i;
+
+      for (i = 0; i < numOps; i++) {
+        uint16_t width = pucRunOp[3] - pucRunOp[1] + 1;
+        uint32_t ulPixel = (uint32_t)(y - y0) * width;
+
+        for (x = 0; x < width; x++) {
+          Crystalfontz128x128_PackPixel(
+              pucLine, ulIndex++,
+              Crystalfontz128x128_OpPixel(pucRunOp, ulPixel++));
+        }
+        pucRunOp += Crystalfontz128x128_OpBytes(pucRunOp);
+      }
+
+      Crystalfontz128x128_EndRow(pucLine, ulIndex, y == y1);
+    }
+#endif
+  }
+}
+
+//*****************************************************************************
+//
+//! Draws a rectangle of pixels which are already in the panel's native format.
+//!
+//! \param x0 is the X coordinate of the upper left corner.
+//! \param y0 is the Y coordinate of the upper left corner.
+//! \param x1 is the X coordinate of the lower right corner.
+//! \param y1 is the Y coordinate of the lower right corner.
+//! \param pucData points to the pixels, row by row, in the interface pixel
+//! format written by Crystalfontz128x128_PackPixel().
+//!
+//! The whole rectangle is sent through a single draw window.  The rectangle
+//! is inclusive and assumed to be within the extents of the display.  With
+//! DMA enabled the transfer continues after this function returns, so the
+//! pixel data must stay valid until Crystalfontz128x128_WaitForCompletion()
+//! returns.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_DrawNativeRect(uint16_t x0, uint16_t y0, uint16_t x1,
+                                        uint16_t y1, const uint8_t *pucData) {
+  uint32_t numBytes = LCD_PIXEL_BYTES((uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1));
+
+  Crystalfontz128x128_RecordPixels(x0, y0, x1, y1, pucData, 0);
+
+#if LCD_USE_SHADOW_BUFFER
+  uint16_t y;
+  for (y = y0; y <= y1; y++) {
+    Crystalfontz128x128_ShadowWriteRow(x0, y, pucData,
+                                       (uint32_t)(y - y0) * (x1 - x0 + 1),
+                                       x1 - x0 + 1);
+  }
+  return;
+#endif
+
+  Crystalfontz128x128_SetDrawFrame(x0, y0, x1, y1);
+  HAL_LCD_writeCommand(CM_RAMWR);
+  HAL_LCD_startBuffer(pucData, numBytes);
+}
+
+// Draw window being written by Crystalfontz128x128_StreamRun(), the position
+// of the next pixel within it, and the number of pixels staged in the current
+// line buffer
+static uint16_t Lcd_StreamX0, Lcd_StreamX1, Lcd_StreamX, Lcd_StreamY;
+static uint32_t Lcd_StreamStaged;
+
+//*****************************************************************************
+//
+// Sends the pixels staged for the current stream.  In 12-bit mode only an
+// even number of pixels is ever sent before the end of the stream, so that no
+// packed byte is split between two transfers.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_StreamFlush(void) {
+  if (Lcd_StreamStaged == 0) return;
+
+  HAL_LCD_startBuffer(Lcd_LineBuffer[Lcd_LineBufferIndex],
+                      LCD_PIXEL_BYTES(Lcd_StreamStaged));
+  Lcd_LineBufferIndex ^= 1;
+  Lcd_StreamStaged = 0;
+}
+
+static void Crystalfontz128x128_StreamStage(uint16_t ulValue) {
+  Crystalfontz128x128_PackPixel(Lcd_LineBuffer[Lcd_LineBufferIndex],
+                                Lcd_StreamStaged++, ulValue);
+  if (Lcd_StreamStaged == LCD_HORIZONTAL_MAX) Crystalfontz128x128_StreamFlush();
+}
+
+//*****************************************************************************
+//
+// Keeps track of where a run of the current stream lands on the screen, for
+// the shadow buffer and for a display list being recorded.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_StreamTrack(uint16_t ulValue,
+                                            uint32_t ulCount) {
+  uint32_t ulRemaining = ulCount;
+
+  while (ulRemaining > 0) {
+    uint32_t ulSegment = Lcd_StreamX1 - Lcd_StreamX + 1;
+    if (ulSegment > ulRemaining) ulSegment = ulRemaining;
+
+    int16_t x1 = Lcd_StreamX + ulSegment - 1;
+    Crystalfontz128x128_RecordFill(Lcd_StreamX, Lcd_StreamY, x1, Lcd_StreamY,
+                                   ulValue);
+#if LCD_USE_SHADOW_BUFFER
+    Crystalfontz128x128_ShadowFill(Lcd_StreamX, Lcd_StreamY, x1, Lcd_StreamY,
+                                   ulValue);
+#endif
+
+    Lcd_StreamX += ulSegment;
+    if (Lcd_StreamX > Lcd_StreamX1) {
+      Lcd_StreamX = Lcd_StreamX0;
+      Lcd_StreamY++;
+    }
+    ulRemaining -= ulSegment;
+  }
+}
+
+//*****************************************************************************
+//
+//! Opens a draw window to be filled by Crystalfontz128x128_StreamRun().
+//!
+//! \param x0 is the X coordinate of the upper left corner.
+//! \param y0 is the Y coordinate of the upper left corner.
+//! \param x1 is the X coordinate of the lower right corner.
+//! \param y1 is the Y coordinate of the lower right corner.
+//!
+//! The window is inclusive and assumed to be within the extents of the
+//! display.  It is filled left to right, then top to bottom.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_BeginStream(uint16_t x0, uint16_t y0, uint16_t x1,
+                                     uint16_t y1) {
+  Lcd_StreamX0 = Lcd_StreamX = x0;
+  Lcd_StreamX1 = x1;
+  Lcd_StreamY = y0;
+  Lcd_StreamStaged = 0;
+
+#if !LCD_USE_SHADOW_BUFFER
+  Crystalfontz128x128_SetDrawFrame(x0, y0, x1, y1);
+  HAL_LCD_writeCommand(CM_RAMWR);
+#endif
+}
+
+//*****************************************************************************
+//
+//! Writes a run of pixels of one color into the window opened by
+//! Crystalfontz128x128_BeginStream().
+//!
+//! \param ulValue is the display-driver specific color of the run.
+//! \param ulCount is the number of pixels in the run, which may span rows.
+//!
+//! Short runs are staged in a line buffer and sent in batches.  Runs of at
+//! least \b LCD_STREAM_FILL_PIXELS pixels are sent as a fill, so a long run
+//! costs no more than filling a rectangle.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_StreamRun(uint16_t ulValue, uint32_t ulCount) {
+  Crystalfontz128x128_StreamTrack(ulValue, ulCount);
+
+#if !LCD_USE_SHADOW_BUFFER
+  if (ulCount < LCD_STREAM_FILL_PIXELS) {
+    while (ulCount--) Crystalfontz128x128_StreamStage(ulValue);
+    return;
+  }
+
+#if LCD_COLOR_BITS == 12
+  // Start and end the fill on a whole packed byte
+  if (Lcd_StreamStaged & 1) {
+    Crystalfontz128x128_StreamStage(ulValue);
+    ulCount--;
+  }
+  Crystalfontz128x128_StreamFlush();
+  HAL_LCD_startFill(ulValue, ulCount & ~1);
+  if (ulCount & 1) Crystalfontz128x128_StreamStage(ulValue);
+#else
+  Crystalfontz128x128_StreamFlush();
+  HAL_LCD_startFill(ulValue, ulCount);
+#endif
+#endif
+}
+
+//*****************************************************************************
+//
+//! Adds pixels of different colors to the window opened by
+//! Crystalfontz128x128_BeginStream().
+//!
+//! \param pusPixels holds one display-driver specific color per pixel.
+//! \param ulCount is the number of pixels, which may span rows.
+//!
+//! The pixels are written straight from \e pusPixels with the transmit
+//! buffer kept full, instead of being staged one at a time, so this is the
+//! cheap way to put back a saved block of the screen.  They have all been
+//! sent when this function returns.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_StreamPixels(const uint16_t *pusPixels,
+                                      uint32_t ulCount) {
+  uint32_t i;
+
+  for (i = 0; i < ulCount; i++)
+    Crystalfontz128x128_StreamTrack(pusPixels[i], 1);
+
+#if !LCD_USE_SHADOW_BUFFER
+#if LCD_COLOR_BITS == 12
+  // Start and end the burst on a whole packed byte
+  if (ulCount && (Lcd_StreamStaged & 1)) {
+    Crystalfontz128x128_StreamStage(*pusPixels++);
+    ulCount--;
+  }
+  Crystalfontz128x128_StreamFlush();
+  HAL_LCD_writeBuffer(pusPixels, ulCount & ~1);
+  if (ulCount & 1) Crystalfontz128x128_StreamStage(pusPixels[ulCount - 1]);
+#else
+  Crystalfontz128x128_StreamFlush();
+  HAL_LCD_writeBuffer(pusPixels, ulCount);
+#endif
+#endif
+}
+
+//*****************************************************************************
+//
+//! Sends whatever is left of the window opened by
+//! Crystalfontz128x128_BeginStream().
+//!
+//! The last pixels may still be streaming when this function returns.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void Crystalfontz128x128_EndStream(void) {
+#if !LCD_USE_SHADOW_BUFFER
+  Crystalfontz128x128_StreamFlush();
+#endif
+}
+
+//*****************************************************************************
+//
+//! Reads a rectangle of panel memory back over the LCD link.
+//!
+//! \param x0 is the left column of the rectangle.
+//! \param y0 is the top row of the rectangle.
+//! \param x1 is the right column of the rectangle.
+//! \param y1 is the bottom row of the rectangle.
+//! \param pusPixels receives the pixels row by row, as panel-native colors.
+//!
+//! The panel returns every pixel as 18-bit color, one byte each for red, green
+//! and blue with the six significant bits at the top, after a dummy byte.  The
+//! bits are clocked in by the CPU, so this is far slower than drawing the same
+//! rectangle and is meant for small areas.  Any transfer still streaming to
+//! the panel is finished first.
+//!
+//! \return true if the pixels were read, false if the driver was built
+//! without \b LCD_USE_READBACK.
+//
+//*****************************************************************************
+bool Crystalfontz128x128_ReadRect(uint16_t x0, uint16_t y0, uint16_t x1,
+                                  uint16_t y1, uint16_t *pusPixels) {
+#if LCD_USE_READBACK
+  uint32_t ulCount = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+
+  Crystalfontz128x128_SetDrawFrame(x0, y0, x1, y1);
+  HAL_LCD_writeCommand(CM_RAMRD);
+
+  Lcd_FlagRead = 1;
+  HAL_LCD_beginRead();
+  HAL_LCD_readData();
+
+  while (ulCount--) {
+    uint8_t r = HAL_LCD_readData();
+    uint8_t g = HAL_LCD_readData();
+    uint8_t b = HAL_LCD_readData();
+#if LCD_COLOR_BITS == 12
+    *pusPixels++ = ((r & 0xF0) << 4) | (g & 0xF0) | (b >> 4);
+#else
+    *pusPixels++ = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+#endif
+  }
+
+  HAL_LCD_endRead();
+  Lcd_FlagRead = 0;
+  return true;
+#else
+  return false;
+#endif
+}
+
+//*****************************************************************************
+//
+//! Copies what is currently shown in a rectangle of the screen.
+//!
+//! \param x0 is the left column of the rectangle.
+//! \param y0 is the top row of the rectangle.
+//! \param x1 is the right column of the rectangle.
+//! \param y1 is the bottom row of the rectangle.
+//! \param pusPixels receives the pixels row by row, as panel-native colors.
+//!
+//! The pixels come from the shadow buffer when there is one, since it holds
+//! everything drawn so far including what has not reached the panel yet, and
+//! are otherwise read back from the panel with
+//! Crystalfontz128x128_ReadRect().
+//!
+//! \return true if the pixels were copied, false if the driver has neither a
+//! shadow buffer nor readback.
+//
+//*****************************************************************************
+bool Crystalfontz128x128_CaptureRect(uint16_t x0, uint16_t y0, uint16_t x1,
+                                     uint16_t y1, uint16_t *pusPixels) {
+#if LCD_USE_SHADOW_BUFFER
+  uint16_t x, y;
+
+  for (y = y0; y <= y1; y++) {
+    for (x = x0; x <= x1; x++) {
+      *pusPixels++ = Lcd_ShadowPalette[Crystalfontz128x128_ShadowGet(x, y)];
+    }
+  }
+  return true;
+#else
+  return Crystalfontz128x128_ReadRect(x0, y0, x1, y1, pusPixels);
+#endif
+}
+
+//*****************************************************************************
+//
+//! Tells whether Crystalfontz128x128_CaptureRect() can work in this build.
+//!
+//! \return true if the driver has a shadow buffer or panel readback.
+//
+//*****************************************************************************
+bool Crystalfontz128x128_CanCapture(void) {
+  return LCD_USE_SHADOW_BUFFER || LCD_USE_READBACK;
 }
 
 //*****************************************************************************
@@ -205,14 +1467,20 @@ void Crystalfontz128x128_SetOrientation(uint8_t orientation) {
 static void Crystalfontz128x128_PixelDraw(const Graphics_Display *pDisplay,
                                           int16_t lX, int16_t lY,
                                           uint16_t ulValue) {
+  Crystalfontz128x128_RecordFill(lX, lY, lX, lY, ulValue);
+
+#if LCD_USE_SHADOW_BUFFER
+  Crystalfontz128x128_ShadowFill(lX, lY, lX, lY, ulValue);
+  return;
+#endif
+
   Crystalfontz128x128_SetDrawFrame(lX, lY, lX, lY);
 
   //
   // Write the pixel value.
   //
   HAL_LCD_writeCommand(CM_RAMWR);
-  HAL_LCD_writeData(ulValue >> 8);
-  HAL_LCD_writeData(ulValue);
+  HAL_LCD_writePixels(ulValue, 1);
 }
 
 //*****************************************************************************
@@ -245,12 +1513,16 @@ static void Crystalfontz128x128_PixelDrawMultiple(
     int16_t lCount, int16_t lBPP, const uint8_t *pucData,
     const uint32_t *pucPalette) {
   uint16_t Data;
+  int16_t numPixels = lCount;
 
   //
-  // Set the cursor increment to left to right, followed by top to bottom.
+  // Expand the row into a staging buffer in the interface pixel format so that
+  // it can be streamed out in a single transfer.  The coordinates are within
+  // the display, so a row never holds more than LCD_HORIZONTAL_MAX pixels.
   //
-  Crystalfontz128x128_SetDrawFrame(lX, lY, lX + lCount, 127);
-  HAL_LCD_writeCommand(CM_RAMWR);
+  uint8_t *pucLine = Lcd_LineBuffer[Lcd_LineBufferIndex];
+  uint32_t ulOut = 0;
+  Lcd_LineBufferIndex ^= 1;
 
   //
   // Determine how to interpret the pixel data based on the number of bits
@@ -267,9 +1539,8 @@ static void Crystalfontz128x128_PixelDrawMultiple(
         // Loop through the pixels in this byte of image data
         for (; (lX0 < 8) && lCount; lX0++, lCount--) {
           // Draw this pixel in the appropriate color
-          HAL_LCD_writeData(
-              (((uint32_t *)pucPalette)[(Data >> (7 - lX0)) & 1]) >> 8);
-          HAL_LCD_writeData(((uint32_t *)pucPalette)[(Data >> (7 - lX0)) & 1]);
+          uint32_t ulColor = ((uint32_t *)pucPalette)[(Data >> (7 - lX0)) & 1];
+          Crystalfontz128x128_PackPixel(pucLine, ulOut++, ulColor);
         }
 
         // Start at the beginning of the next byte of image data
@@ -297,9 +1568,8 @@ static void Crystalfontz128x128_PixelDrawMultiple(
             // and extract the corresponding entry from the palette
             Data = (*pucData >> 4);
             Data = (*(uint16_t *)(pucPalette + Data));
-            // Write to LCD screen
-            HAL_LCD_writeData(Data >> 8);
-            HAL_LCD_writeData(Data);
+            // Write to the staging buffer
+            Crystalfontz128x128_PackPixel(pucLine, ulOut++, Data);
 
             // Decrement the count of pixels to draw
             lCount--;
@@ -312,9 +1582,8 @@ static void Crystalfontz128x128_PixelDrawMultiple(
                 // the palette
                 Data = (*pucData++ & 15);
                 Data = (*(uint16_t *)(pucPalette + Data));
-                // Write to LCD screen
-                HAL_LCD_writeData(Data >> 8);
-                HAL_LCD_writeData(Data);
+                // Write to the staging buffer
+                Crystalfontz128x128_PackPixel(pucLine, ulOut++, Data);
 
                 // Decrement the count of pixels to draw
                 lCount--;
@@ -334,9 +1603,8 @@ static void Crystalfontz128x128_PixelDrawMultiple(
         // corresponding entry from the palette
         Data = *pucData++;
         Data = (*(uint16_t *)(pucPalette + Data));
-        // Write to LCD screen
-        HAL_LCD_writeData(Data >> 8);
-        HAL_LCD_writeData(Data);
+        // Write to the staging buffer
+        Crystalfontz128x128_PackPixel(pucLine, ulOut++, Data);
       }
       // The image data has been drawn
       break;
@@ -359,12 +1627,26 @@ static void Crystalfontz128x128_PixelDrawMultiple(
         usData = *((uint16_t *)pucData);
         pucData += 2;
 
-        // Translate this palette entry and write it to the screen
-        HAL_LCD_writeData(usData >> 8);
-        HAL_LCD_writeData(usData);
+        // Pack into the interface pixel format
+        Crystalfontz128x128_PackPixel(pucLine, ulOut++, usData);
       }
     }
   }
+
+  Crystalfontz128x128_RecordPixels(lX, lY, lX + numPixels - 1, lY, pucLine, 0);
+
+#if LCD_USE_SHADOW_BUFFER
+  Crystalfontz128x128_ShadowWriteRow(lX, lY, pucLine, 0, numPixels);
+  return;
+#endif
+
+  //
+  // Set the cursor increment to left to right, followed by top to bottom,
+  // and stream the expanded row out.
+  //
+  Crystalfontz128x128_SetDrawFrame(lX, lY, lX + numPixels, 127);
+  HAL_LCD_writeCommand(CM_RAMWR);
+  HAL_LCD_startBuffer(pucLine, LCD_PIXEL_BYTES(ulOut));
 }
 
 //*****************************************************************************
@@ -387,17 +1669,20 @@ static void Crystalfontz128x128_PixelDrawMultiple(
 static void Crystalfontz128x128_LineDrawH(const Graphics_Display *pDisplay,
                                           int16_t lX1, int16_t lX2, int16_t lY,
                                           uint16_t ulValue) {
+  Crystalfontz128x128_RecordFill(lX1, lY, lX2, lY, ulValue);
+
+#if LCD_USE_SHADOW_BUFFER
+  Crystalfontz128x128_ShadowFill(lX1, lY, lX2, lY, ulValue);
+  return;
+#endif
+
   Crystalfontz128x128_SetDrawFrame(lX1, lY, lX2, lY);
 
   //
   // Write the pixel value.
   //
-  int16_t i;
   HAL_LCD_writeCommand(CM_RAMWR);
-  for (i = lX1; i <= lX2; i++) {
-    HAL_LCD_writeData(ulValue >> 8);
-    HAL_LCD_writeData(ulValue);
-  }
+  HAL_LCD_startFill(ulValue, lX2 - lX1 + 1);
 }
 
 //*****************************************************************************
@@ -420,17 +1705,20 @@ static void Crystalfontz128x128_LineDrawH(const Graphics_Display *pDisplay,
 static void Crystalfontz128x128_LineDrawV(const Graphics_Display *pDisplay,
                                           int16_t lX, int16_t lY1, int16_t lY2,
                                           uint16_t ulValue) {
+  Crystalfontz128x128_RecordFill(lX, lY1, lX, lY2, ulValue);
+
+#if LCD_USE_SHADOW_BUFFER
+  Crystalfontz128x128_ShadowFill(lX, lY1, lX, lY2, ulValue);
+  return;
+#endif
+
   Crystalfontz128x128_SetDrawFrame(lX, lY1, lX, lY2);
 
   //
   // Write the pixel value.
   //
-  int16_t i;
   HAL_LCD_writeCommand(CM_RAMWR);
-  for (i = lY1; i <= lY2; i++) {
-    HAL_LCD_writeData(ulValue >> 8);
-    HAL_LCD_writeData(ulValue);
-  }
+  HAL_LCD_startFill(ulValue, lY2 - lY1 + 1);
 }
 
 //*****************************************************************************
@@ -458,18 +1746,21 @@ static void Crystalfontz128x128_RectFill(const Graphics_Display *pDisplay,
   int16_t y0 = pRect->sYMin;
   int16_t y1 = pRect->sYMax;
 
+  Crystalfontz128x128_RecordFill(x0, y0, x1, y1, ulValue);
+
+#if LCD_USE_SHADOW_BUFFER
+  Crystalfontz128x128_ShadowFill(x0, y0, x1, y1, ulValue);
+  return;
+#endif
+
   Crystalfontz128x128_SetDrawFrame(x0, y0, x1, y1);
 
   //
   // Write the pixel value.
   //
-  int16_t i;
-  int16_t pixels = (x1 - x0 + 1) * (y1 - y0 + 1);
+  uint32_t pixels = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
   HAL_LCD_writeCommand(CM_RAMWR);
-  for (i = 0; i <= pixels; i++) {
-    HAL_LCD_writeData(ulValue >> 8);
-    HAL_LCD_writeData(ulValue);
-  }
+  HAL_LCD_startFill(ulValue, pixels);
 }
 
 //*****************************************************************************
@@ -491,11 +1782,19 @@ static void Crystalfontz128x128_RectFill(const Graphics_Display *pDisplay,
 //*****************************************************************************
 static uint32_t Crystalfontz128x128_ColorTranslate(
     const Graphics_Display *pDisplay, uint32_t ulValue) {
+#if LCD_COLOR_BITS == 12
+  //
+  // Translate from a 24-bit RGB color to a 4-4-4 RGB color.
+  //
+  return (((((ulValue) & 0x00f00000) >> 12) | (((ulValue) & 0x0000f000) >> 8) |
+           (((ulValue) & 0x000000f0) >> 4)));
+#else
   //
   // Translate from a 24-bit RGB color to a 5-6-5 RGB color.
   //
   return (((((ulValue) & 0x00f80000) >> 8) | (((ulValue) & 0x0000fc00) >> 5) |
            (((ulValue) & 0x000000f8) >> 3)));
+#endif
 }
 
 //*****************************************************************************
@@ -507,16 +1806,16 @@ static uint32_t Crystalfontz128x128_ColorTranslate(
 //!
 //! This functions flushes any cached drawing operations to the display.  This
 //! is useful when a local frame buffer is used for drawing operations, and the
-//! flush would copy the local frame buffer to the display.  For the SSD2119
-//! driver, the flush is a no operation.
+//! flush would copy the local frame buffer to the display.  When the shadow
+//! buffer is enabled its dirty regions are pushed to the panel; in either case
+//! the flush then waits for any DMA transfer still in flight to finish.
 //!
 //! \return None.
 //
 //*****************************************************************************
 static void Crystalfontz128x128_Flush(const Graphics_Display *pDisplay) {
-  //
-  // There is nothing to be done.
-  //
+  Crystalfontz128x128_FlushDirty();
+  HAL_LCD_waitForCompletion();
 }
 
 //*****************************************************************************
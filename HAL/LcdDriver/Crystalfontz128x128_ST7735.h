@@ -48,6 +48,9 @@
 #define LCD_VERTICAL_MAX 128
 #define LCD_HORIZONTAL_MAX 128
 
+// Number of rows in the ST7735 frame memory for the 128x128 glass
+#define LCD_FRAME_MEMORY_ROWS 132
+
 #define LCD_ORIENTATION_UP 0
 #define LCD_ORIENTATION_LEFT 1
 #define LCD_ORIENTATION_DOWN 2
@@ -73,8 +76,12 @@
 #define CM_RGBSET 0x2d
 #define CM_RAMRD 0x2E
 #define CM_PTLAR 0x30
+#define CM_SCRLAR 0x33
 #define CM_MADCTL 0x36
+#define CM_VSCSAD 0x37
 #define CM_COLMOD 0x3A
+#define CM_COLMOD_12BIT 0x03
+#define CM_COLMOD_16BIT 0x05
 #define CM_SETPWCTR 0xB1
 #define CM_SETDISPL 0xB2
 #define CM_FRMCTR3 0xB3
@@ -92,6 +99,14 @@
 #define CM_MADCTL_BGR 0x08
 #define CM_MADCTL_MH 0x04
 
+// Storage for a recorded display list, see Crystalfontz128x128_BeginRecording()
+typedef struct {
+  uint8_t *pucData;
+  uint32_t ulSize;
+  uint32_t ulLength;
+  bool bOverflow;
+} Crystalfontz128x128_DisplayList;
+
 extern uint8_t Lcd_Orientation;
 extern uint16_t Lcd_ScreenWidth, Lcd_ScreenHeigth;
 extern uint8_t Lcd_PenSolid, Lcd_FontSolid, Lcd_FlagRead;
@@ -103,9 +118,60 @@ extern const Graphics_Display_Functions g_sCrystalfontz128x128_funcs;
 
 extern void Crystalfontz128x128_Init(void);
 
+extern uint32_t Crystalfontz128x128_InitStep(void);
+
+extern void Crystalfontz128x128_DisplayOn(void);
+
 extern void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0,
                                              uint16_t x1, uint16_t y1);
 
 extern void Crystalfontz128x128_SetOrientation(uint8_t orientation);
 
+extern bool Crystalfontz128x128_IsBusy(void);
+
+extern void Crystalfontz128x128_WaitForCompletion(void);
+
+extern void Crystalfontz128x128_FlushDirty(void);
+
+extern bool Crystalfontz128x128_SetScrollArea(uint16_t top, uint16_t bottom);
+
+extern void Crystalfontz128x128_SetScrollOffset(uint16_t offset);
+
+extern void Crystalfontz128x128_StopScroll(void);
+
+extern void Crystalfontz128x128_PackPixel(uint8_t *pucData, uint32_t ulIndex,
+                                          uint16_t ulValue);
+
+extern void Crystalfontz128x128_DrawNativeRect(uint16_t x0, uint16_t y0,
+                                               uint16_t x1, uint16_t y1,
+                                               const uint8_t *pucData);
+
+extern void Crystalfontz128x128_BeginStream(uint16_t x0, uint16_t y0,
+                                            uint16_t x1, uint16_t y1);
+
+extern void Crystalfontz128x128_StreamRun(uint16_t ulValue, uint32_t ulCount);
+
+extern void Crystalfontz128x128_StreamPixels(const uint16_t *pusPixels,
+                                             uint32_t ulCount);
+
+extern void Crystalfontz128x128_EndStream(void);
+
+extern bool Crystalfontz128x128_ReadRect(uint16_t x0, uint16_t y0,
+                                         uint16_t x1, uint16_t y1,
+                                         uint16_t *pusPixels);
+
+extern bool Crystalfontz128x128_CaptureRect(uint16_t x0, uint16_t y0,
+                                            uint16_t x1, uint16_t y1,
+                                            uint16_t *pusPixels);
+
+extern bool Crystalfontz128x128_CanCapture(void);
+
+extern void Crystalfontz128x128_BeginRecording(
+    Crystalfontz128x128_DisplayList *pList);
+
+extern bool Crystalfontz128x128_EndRecording(void);
+
+extern void Crystalfontz128x128_ReplayDisplayList(const uint8_t *pucData,
+                                                  uint32_t ulLength);
+
 #endif /* __CRYSTALFONTZLCD_H__ */
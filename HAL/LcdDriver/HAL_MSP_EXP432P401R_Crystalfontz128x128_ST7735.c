@@ -42,6 +42,24 @@
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include <ti/grlib/grlib.h>
 
+#if LCD_USE_DMA
+#include <HAL/Dma.h>
+
+// State of the transfer currently streaming to the LCD. Long transfers are
+// split into chunks which are re-armed from the DMA completion interrupt.
+static volatile bool lcdDmaActive = false;
+static volatile uint32_t lcdDmaBytesRemaining;
+static const uint8_t *volatile lcdDmaSource;
+static uint32_t lcdDmaSourceIncrement;
+static uint32_t lcdDmaChunkSize;
+static bool lcdDmaSourceAdvances;
+
+// Repeating source pattern for constant-color fills
+static uint8_t lcdDmaPattern[LCD_PIXEL_BYTES(LCD_DMA_PATTERN_PIXELS)];
+static uint16_t lcdDmaPatternColor;
+static bool lcdDmaPatternValid = false;
+#endif
+
 void HAL_LCD_PortInit(void) {
   // LCD_SCK
   GPIO_setAsPeripheralModuleFunctionOutputPin(LCD_SCK_PORT, LCD_SCK_PIN,
@@ -81,6 +99,9 @@ void HAL_LCD_SpiInit(void) {
 //
 //*****************************************************************************
 void HAL_LCD_writeCommand(uint8_t command) {
+  // Let any pending DMA transfer finish before touching the D/C line
+  HAL_LCD_waitForCompletion();
+
   // Set to command mode
   GPIO_setOutputLowOnPin(LCD_DC_PORT, LCD_DC_PIN);
 
@@ -107,8 +128,7 @@ void HAL_LCD_writeCommand(uint8_t command) {
 //*****************************************************************************
 void HAL_LCD_writeData(uint8_t data) {
   // USCI_B0 Busy? //
-  while (UCB0STATW & UCBUSY)
-    ;
+  HAL_LCD_waitForCompletion();
 
   // Transmit data
   UCB0TXBUF = data;
@@ -118,6 +138,330 @@ void HAL_LCD_writeData(uint8_t data) {
     ;
 }
 
+//*****************************************************************************
+//
+// Hands one byte to the SPI module as soon as its transmit buffer is free.
+// Unlike HAL_LCD_writeData() it does not wait for the byte to be shifted
+// out, so the next byte is already queued when the shifter runs dry and the
+// clock keeps going. HAL_LCD_writeCommand() waits for the line to go idle
+// before D/C changes.
+//
+//*****************************************************************************
+static inline void HAL_LCD_feedByte(uint8_t data) {
+  while (!(UCB0IFG & UCTXIFG))
+    ;
+  UCB0TXBUF = data;
+}
+
+//*****************************************************************************
+//
+// Writes count pixels of one color, in the interface pixel format, by
+// keeping the SPI transmit buffer fed from the CPU. The caller must already
+// have opened a draw window with CM_RAMWR.
+//
+//*****************************************************************************
+void HAL_LCD_writePixels(uint16_t color, uint32_t count) {
+  HAL_LCD_waitForCompletion();
+
+#if LCD_COLOR_BITS == 12
+  uint8_t pattern[3] = {color >> 4, (color << 4) | ((color >> 8) & 0x0F),
+                        color};
+
+  for (; count >= 2; count -= 2) {
+    HAL_LCD_feedByte(pattern[0]);
+    HAL_LCD_feedByte(pattern[1]);
+    HAL_LCD_feedByte(pattern[2]);
+  }
+  if (count) {
+    HAL_LCD_feedByte(pattern[0]);
+    HAL_LCD_feedByte(pattern[1] & 0xF0);
+  }
+#else
+  while (count--) {
+    HAL_LCD_feedByte(color >> 8);
+    HAL_LCD_feedByte(color);
+  }
+#endif
+}
+
+//*****************************************************************************
+//
+// Writes numBytes of data, already in the panel's byte order, by keeping the
+// SPI transmit buffer fed from the CPU. Unlike HAL_LCD_startBuffer() it never
+// uses DMA, so data may be released, or go out of scope, once it returns.
+//
+//*****************************************************************************
+void HAL_LCD_writeBytes(const uint8_t *data, uint32_t numBytes) {
+  HAL_LCD_waitForCompletion();
+  while (numBytes--) HAL_LCD_feedByte(*data++);
+}
+
+//*****************************************************************************
+//
+// Writes count pixels, given as one interface-format color each, by keeping
+// the SPI transmit buffer fed from the CPU. In 12-bit mode the pixels are
+// packed two to three bytes on the way out. The caller must already have
+// opened a draw window with CM_RAMWR.
+//
+//*****************************************************************************
+void HAL_LCD_writeBuffer(const uint16_t *pixels, uint32_t count) {
+  HAL_LCD_waitForCompletion();
+
+#if LCD_COLOR_BITS == 12
+  for (; count >= 2; count -= 2, pixels += 2) {
+    HAL_LCD_feedByte(pixels[0] >> 4);
+    HAL_LCD_feedByte((pixels[0] << 4) | ((pixels[1] >> 8) & 0x0F));
+    HAL_LCD_feedByte(pixels[1]);
+  }
+  if (count) {
+    HAL_LCD_feedByte(pixels[0] >> 4);
+    HAL_LCD_feedByte(pixels[0] << 4);
+  }
+#else
+  while (count--) {
+    HAL_LCD_feedByte(*pixels >> 8);
+    HAL_LCD_feedByte(*pixels++);
+  }
+#endif
+}
+
+//*****************************************************************************
+//
+// Configures the uDMA controller to feed the LCD's SPI transmit buffer. The
+// LCD shares its channel with the USB UART (see <HAL/Dma.h>); while it owns
+// the channel, the channel is triggered by the EUSCI_B0 transmit flag and
+// raises an interrupt at the end of every chunk so that long transfers can be
+// re-armed.
+//
+//*****************************************************************************
+void HAL_LCD_DmaInit(void) {
+#if LCD_USE_DMA
+  Dma_init();
+#endif
+}
+
+#if LCD_USE_DMA
+//*****************************************************************************
+//
+// Arms the DMA channel for the next chunk of the current transfer and kicks
+// off the first request by toggling the SPI transmit flag.
+//
+//*****************************************************************************
+static void HAL_LCD_startDmaChunk(void) {
+  uint32_t chunk = lcdDmaBytesRemaining;
+  if (chunk > lcdDmaChunkSize) chunk = lcdDmaChunkSize;
+
+  Dma_start(lcdDmaSource,
+            (volatile void *)SPI_getTransmitBufferAddressForDMA(LCD_EUSCI_BASE),
+            chunk, lcdDmaSourceIncrement);
+
+  lcdDmaBytesRemaining -= chunk;
+  if (lcdDmaSourceAdvances) lcdDmaSource += chunk;
+
+  UCB0IFG &= ~UCTXIFG;
+  UCB0IFG |= UCTXIFG;
+}
+
+//*****************************************************************************
+//
+// DMA completion handler. Re-arms the channel while the current transfer
+// still has bytes left, and otherwise gives the channel back and marks the LCD
+// link as idle.
+//
+//*****************************************************************************
+static void HAL_LCD_dmaDone(void) {
+  if (lcdDmaBytesRemaining > 0) {
+    HAL_LCD_startDmaChunk();
+  } else {
+    Dma_release();
+    lcdDmaActive = false;
+  }
+}
+
+//*****************************************************************************
+//
+// Starts a DMA transfer from source to the LCD and returns immediately. When
+// sourceAdvances is false every chunk restarts at source, which lets a short
+// pattern buffer be replayed for an arbitrarily long fill. Returns false,
+// without sending anything, if the UART is using the channel.
+//
+//*****************************************************************************
+static bool HAL_LCD_startDma(const uint8_t *source, uint32_t numBytes,
+                             uint32_t sourceIncrement, bool sourceAdvances,
+                             uint32_t chunkSize) {
+  if (!Dma_acquire(LCD_DMA_CHANNEL_MAPPING, HAL_LCD_dmaDone)) return false;
+
+  lcdDmaSource = source;
+  lcdDmaBytesRemaining = numBytes;
+  lcdDmaSourceIncrement = sourceIncrement;
+  lcdDmaSourceAdvances = sourceAdvances;
+  lcdDmaChunkSize = chunkSize;
+  lcdDmaActive = true;
+
+  HAL_LCD_startDmaChunk();
+  return true;
+}
+#endif
+
+//*****************************************************************************
+//
+// Streams count pixels of a single color to the LCD. The caller must already
+// have opened a draw window with CM_RAMWR. With DMA enabled this returns as
+// soon as the transfer is started; a color whose bytes are all equal (black,
+// white, ...) is sent from a fixed source address, every other color from a
+// small repeating pattern buffer. The color is in the interface pixel format
+// selected by LCD_COLOR_BITS.
+//
+//*****************************************************************************
+void HAL_LCD_startFill(uint16_t color, uint32_t count) {
+#if LCD_USE_DMA
+  uint32_t numBytes = LCD_PIXEL_BYTES(count);
+
+  if (numBytes >= LCD_DMA_MIN_BYTES) {
+#if LCD_COLOR_BITS == 12
+    // Two RGB444 pixels pack into three bytes, so the bytes repeat every three
+    uint8_t pattern[3] = {color >> 4, (color << 4) | ((color >> 8) & 0x0F),
+                          color};
+#else
+    uint8_t pattern[2] = {color >> 8, color};
+#endif
+    uint32_t i;
+
+    HAL_LCD_waitForCompletion();
+
+    bool uniform = true;
+    for (i = 1; i < sizeof(pattern); i++) uniform &= pattern[i] == pattern[0];
+
+    if (uniform) {
+      lcdDmaPattern[0] = pattern[0];
+      lcdDmaPatternValid = false;
+      if (HAL_LCD_startDma(lcdDmaPattern, numBytes, UDMA_SRC_INC_NONE, false,
+                           DMA_MAX_TRANSFERS))
+        return;
+    } else {
+      if (!lcdDmaPatternValid || lcdDmaPatternColor != color) {
+        for (i = 0; i < sizeof(lcdDmaPattern); i++)
+          lcdDmaPattern[i] = pattern[i % sizeof(pattern)];
+        lcdDmaPatternColor = color;
+        lcdDmaPatternValid = true;
+      }
+
+      if (HAL_LCD_startDma(lcdDmaPattern, numBytes, UDMA_SRC_INC_8, false,
+                           sizeof(lcdDmaPattern)))
+        return;
+    }
+  }
+#endif
+
+  // Short runs, and runs that find the UART using the DMA channel, are fed
+  // by the CPU
+
+  HAL_LCD_writePixels(color, count);
+}
+
+//*****************************************************************************
+//
+// Streams numBytes of pixel data, already in the panel's byte order, to the
+// LCD. The caller must already have opened a draw window with CM_RAMWR. With
+// DMA enabled this returns as soon as the transfer is started, so data must
+// stay valid until HAL_LCD_waitForCompletion() returns.
+//
+//*****************************************************************************
+void HAL_LCD_startBuffer(const uint8_t *data, uint32_t numBytes) {
+#if LCD_USE_DMA
+  if (numBytes >= LCD_DMA_MIN_BYTES) {
+    HAL_LCD_waitForCompletion();
+    if (HAL_LCD_startDma(data, numBytes, UDMA_SRC_INC_8, true,
+                         DMA_MAX_TRANSFERS))
+      return;
+  }
+#endif
+
+  HAL_LCD_writeBytes(data, numBytes);
+}
+
+//*****************************************************************************
+//
+// Returns true while a transfer to the LCD is still in progress.
+//
+//*****************************************************************************
+bool HAL_LCD_isBusy(void) {
+#if LCD_USE_DMA
+  if (lcdDmaActive) return true;
+#endif
+  return (UCB0STATW & UCBUSY) != 0;
+}
+
+//*****************************************************************************
+//
+// Blocks until every byte handed to the LCD has been shifted out.
+//
+//*****************************************************************************
+void HAL_LCD_waitForCompletion(void) {
+#if LCD_USE_DMA
+  while (lcdDmaActive)
+    ;
+#endif
+
+  while (UCB0STATW & UCBUSY)
+    ;
+}
+
+#if LCD_USE_READBACK
+//*****************************************************************************
+//
+// Switches the LCD link over to reading after a read command has been sent.
+// SCK becomes a plain output held low and SDA an input, so that the panel can
+// drive the shared data line.
+//
+//*****************************************************************************
+void HAL_LCD_beginRead(void) {
+  HAL_LCD_waitForCompletion();
+
+  GPIO_setOutputLowOnPin(LCD_SCK_PORT, LCD_SCK_PIN);
+  GPIO_setAsOutputPin(LCD_SCK_PORT, LCD_SCK_PIN);
+  GPIO_setAsInputPin(LCD_MOSI_PORT, LCD_MOSI_PIN);
+}
+
+//*****************************************************************************
+//
+// Clocks one byte out of the panel, MSB first. The panel changes SDA on the
+// falling edge of SCK, so each bit is sampled while the clock is high. The
+// GPIO calls are slow enough to meet the panel's 150 ns read cycle on their
+// own.
+//
+//*****************************************************************************
+uint8_t HAL_LCD_readData(void) {
+  uint8_t data = 0;
+  uint8_t bit;
+
+  for (bit = 0; bit < 8; bit++) {
+    GPIO_setOutputHighOnPin(LCD_SCK_PORT, LCD_SCK_PIN);
+    data = (data << 1) | GPIO_getInputPinValue(LCD_MOSI_PORT, LCD_MOSI_PIN);
+    GPIO_setOutputLowOnPin(LCD_SCK_PORT, LCD_SCK_PIN);
+  }
+
+  return data;
+}
+
+//*****************************************************************************
+//
+// Ends a read: a pulse on CS stops the panel from driving SDA, and both lines
+// go back to the SPI module for the next write.
+//
+//*****************************************************************************
+void HAL_LCD_endRead(void) {
+  GPIO_setOutputHighOnPin(LCD_CS_PORT, LCD_CS_PIN);
+
+  GPIO_setAsPeripheralModuleFunctionOutputPin(LCD_SCK_PORT, LCD_SCK_PIN,
+                                              LCD_SCK_PIN_FUNCTION);
+  GPIO_setAsPeripheralModuleFunctionOutputPin(LCD_MOSI_PORT, LCD_MOSI_PIN,
+                                              LCD_MOSI_PIN_FUNCTION);
+
+  GPIO_setOutputLowOnPin(LCD_CS_PORT, LCD_CS_PIN);
+}
+#endif
+
 //*****************************************************************************
 //
 //! Provides a small delay.
@@ -72,6 +72,52 @@
 // Definition of USCI base address to be used for SPI communication
 #define LCD_EUSCI_BASE EUSCI_B0_BASE
 
+// Interface pixel format: 16 sends RGB565 pixels in two bytes each, 12 sends
+// RGB444 pixels packed two to three bytes. 12-bit mode moves 25% fewer bytes
+// for fills and images at the cost of color depth.
+#define LCD_COLOR_BITS 16
+
+// Number of bytes taken by a run of pixels in the interface pixel format
+#define LCD_PIXEL_BYTES(count) (((uint32_t)(count) * LCD_COLOR_BITS + 7) / 8)
+
+// Set to 1 to stream pixel data to the LCD through the uDMA controller, or to
+// 0 to fall back to the original byte-by-byte polled SPI transfers.
+#define LCD_USE_DMA 1
+
+// uDMA trigger source for EUSCI_B0 SPI transmit, on the channel shared with
+// the USB UART (see <HAL/Dma.h>)
+#define LCD_DMA_CHANNEL_MAPPING DMA_CH0_EUSCIB0TX0
+
+// Transfers shorter than this many bytes are written by the CPU, since setting
+// up a DMA transfer costs more than sending a handful of bytes directly.
+#define LCD_DMA_MIN_BYTES 16
+
+// Number of pixels in the repeating source pattern used for constant-color
+// fills whose bytes differ.
+#define LCD_DMA_PATTERN_PIXELS 128
+
+// Runs of at least this many pixels of one color in a pixel stream, such as a
+// decoded image, are sent as fills instead of being staged in a line buffer.
+#define LCD_STREAM_FILL_PIXELS 16
+
+// Set to 1 to render into a RAM shadow of the panel and only push the regions
+// which actually changed when the display is flushed.
+#define LCD_USE_SHADOW_BUFFER 0
+
+// Bits per pixel of the palette-indexed shadow buffer (4 or 8). 4bpp keeps the
+// buffer at 8 KB of SRAM but limits a screen to 16 distinct colors.
+#define LCD_SHADOW_BPP 4
+
+// Number of dirty rectangles tracked before they are merged together
+#define LCD_SHADOW_MAX_DIRTY_RECTS 8
+
+// Set to 1 to allow reading panel memory back with CM_RAMRD. The BoosterPack
+// only wires the panel's bidirectional SDA line to MOSI, so reads run in the
+// 3-wire serial mode: SCK and SDA are taken away from the SPI module and the
+// bits are clocked in by hand. Leave at 0 when SDA cannot be driven by the
+// panel on the target hardware.
+#define LCD_USE_READBACK 0
+
 //*****************************************************************************
 //
 // Prototypes for the globals exported by this driver.
@@ -81,6 +127,17 @@ extern void HAL_LCD_writeCommand(uint8_t command);
 extern void HAL_LCD_writeData(uint8_t data);
 extern void HAL_LCD_PortInit(void);
 extern void HAL_LCD_SpiInit(void);
+extern void HAL_LCD_DmaInit(void);
+extern void HAL_LCD_writeBytes(const uint8_t *data, uint32_t numBytes);
+extern void HAL_LCD_writePixels(uint16_t color, uint32_t count);
+extern void HAL_LCD_writeBuffer(const uint16_t *pixels, uint32_t count);
+extern void HAL_LCD_startFill(uint16_t color, uint32_t count);
+extern void HAL_LCD_startBuffer(const uint8_t *data, uint32_t numBytes);
+extern bool HAL_LCD_isBusy(void);
+extern void HAL_LCD_waitForCompletion(void);
+extern void HAL_LCD_beginRead(void);
+extern uint8_t HAL_LCD_readData(void);
+extern void HAL_LCD_endRead(void);
 
 // Custom __delay_cycles() for non CCS Compiler
 #if !defined(__TI_ARM__)
@@ -102,6 +102,27 @@ SWTimer SWTimer_construct(uint64_t waitTime_ms) {
   return timer;
 }
 
+/**
+ * Constructs a new Software Timer, using a wait time in microseconds. Apart
+ * from the unit of the wait time, this timer behaves exactly like one built
+ * with SWTimer_construct().
+ *
+ * @param waitTime_us:  The amount of time this timer measures before expiration
+ * @return a SWTimer object
+ */
+SWTimer SWTimer_constructUS(uint64_t waitTime_us) {
+  SWTimer timer;
+
+  timer.startCounter = 0;
+  timer.startRollovers = 0;
+
+  uint64_t counterClock = SYSTEM_CLOCK / PRESCALER;
+  uint64_t cyclesPerMicrosecond = counterClock / US_DIVISION_FACTOR;
+  timer.cyclesToWait = cyclesPerMicrosecond * waitTime_us;
+
+  return timer;
+}
+
 /**
  * Starts a constructed timer by reading the current number of rollovers and
  * current load value in TIMER32_0_BASE.
@@ -57,6 +57,10 @@ typedef struct _SWTimer SWTimer;
 // them.
 SWTimer SWTimer_construct(uint64_t waitTime_ms);
 
+// Constructs a Software timer which measures a wait time given in
+// microseconds, for waits too short to express in milliseconds.
+SWTimer SWTimer_constructUS(uint64_t waitTime_us);
+
 // Starts a software timer. All constructed timers must be started before use.
 void SWTimer_start(SWTimer* timer);
 
@@ -67,6 +71,10 @@ uint64_t SWTimer_elapsedCycles(SWTimer* timer);
 // Returns true if the timer has expired, and false otherwise
 bool SWTimer_expired(SWTimer* timer);
 
+// Returns the number of microseconds which have elapsed since the timer was
+// started.
+uint64_t SWTimer_elapsedTimeUS(SWTimer* timer);
+
 // Initializes the global clock system for the MSP432, as well as a hardware
 // timer under which all of the software timers are based.
 void InitSystemTiming();
@@ -9,6 +9,212 @@
 #include <HAL/Timer.h>
 #include <HAL/UART.h>
 
+#if UART_USE_DMA
+#include <HAL/Dma.h>
+#endif
+
+/** The bit rate of each UART_Baudrate choice */
+static const uint32_t baudRates[NUM_BAUD_CHOICES] = {
+    9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600
+};
+
+/** The receive ring of USB_UART_INSTANCE. The ISR is its only producer and
+ * only moves rxHead; the main loop is its only consumer and only moves rxTail,
+ * so neither side needs to lock out the other. The indices run freely and are
+ * masked on use, which keeps a full ring distinct from an empty one. */
+static volatile uint8_t rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint32_t rxHead = 0;
+static volatile uint32_t rxTail = 0;
+static volatile uint32_t rxOverruns = 0;
+
+/** The transmit ring of USB_UART_INSTANCE, the other way around: the main loop
+ * produces into txHead and the ISR consumes from txTail. */
+static volatile uint8_t txBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint32_t txHead = 0;
+static volatile uint32_t txTail = 0;
+static uint32_t txHighWater = 0;
+
+/** The block queued by UART_writeBlock(), or NULL. It goes out when txTail
+ * reaches txBlockStart, the ring position it was queued at; ring bytes queued
+ * after it wait until it is done. Its fields are volatile so that they are
+ * stored before txBlock, which publishes them to the ISR. txDmaActive is set
+ * while a chunk of it is being sent by DMA, during which the transmit
+ * interrupt is kept off. */
+static const char* volatile txBlock = NULL;
+static volatile uint32_t txBlockLength;
+static volatile uint32_t txBlockStart;
+static UART_TxDone volatile txBlockDone;
+static void* volatile txBlockOwner;
+static volatile bool txDmaActive = false;
+
+/** Bytes of the block still to be sent by the CPU after another module was
+ * turned away from the DMA channel, before the UART tries to claim it again */
+static uint32_t txYieldBytes = 0;
+
+/** Automatic baudrate detection. While autoBaudListening, the receive pin is a
+ * GPIO input whose falling edges interrupt. The ISR stamps each fall with the
+ * system timer into the ring autoBaudFalls, counting them in autoBaudCount;
+ * UART_getAutoBaud() looks for a sync character among the latest. */
+#define AUTOBAUD_FALLS 5
+#define AUTOBAUD_RING_SIZE 8
+
+static volatile bool autoBaudListening = false;
+static volatile uint32_t autoBaudFalls[AUTOBAUD_RING_SIZE];
+static volatile uint32_t autoBaudCount;
+
+/**
+ * Ends the current block and tells its owner the buffer is free
+ */
+static void UART_finishBlock() {
+    UART_TxDone done = txBlockDone;
+    void* owner_p = txBlockOwner;
+
+    txBlock = NULL;
+    txYieldBytes = 0;
+    if (done != NULL) done(owner_p);
+}
+
+#if UART_USE_DMA
+/**
+ * Called from the DMA interrupt once a chunk has been handed to the UART. The
+ * channel goes back at once, and the transmit interrupt takes over again: it
+ * starts the next chunk, unless the LCD has claimed the channel or asked for
+ * it meanwhile, or goes on with the ring.
+ */
+static void UART_dmaDone() {
+    Dma_release();
+    txDmaActive = false;
+
+    if (txBlockLength == 0) UART_finishBlock();
+    UCA0IE |= UCTXIE;
+}
+#endif
+
+/**
+ * Sends the next part of the current block. A whole chunk goes by DMA when the
+ * channel is free and enough is left; otherwise one byte is written by the
+ * CPU. The LCD's transfers are short and keep the main loop waiting, so once
+ * it has been turned away from the channel the UART sends a chunk's worth by
+ * CPU before claiming the channel again. Called from the transmit interrupt
+ * with the transmit register empty.
+ */
+static void UART_sendBlock() {
+#if UART_USE_DMA
+    if (txYieldBytes == 0 && Dma_isWanted(UART_dmaDone)) txYieldBytes = UART_DMA_CHUNK_BYTES;
+
+    if (txYieldBytes > 0) txYieldBytes--;
+    else if (txBlockLength >= UART_DMA_MIN_BYTES && Dma_acquire(UART_DMA_CHANNEL_MAPPING, UART_dmaDone)) {
+        uint32_t chunk = txBlockLength;
+        if (chunk > UART_DMA_CHUNK_BYTES) chunk = UART_DMA_CHUNK_BYTES;
+
+        UCA0IE &= ~UCTXIE;
+        txDmaActive = true;
+
+        Dma_start(txBlock, (volatile void*) UART_getTransmitBufferAddressForDMA(USB_UART_INSTANCE), chunk, UDMA_SRC_INC_8);
+        txBlock += chunk;
+        txBlockLength -= chunk;
+
+        // The transmit flag is already set, so pulse it to raise a request
+        UCA0IFG &= ~UCTXIFG;
+        UCA0IFG |= UCTXIFG;
+        return;
+    }
+#endif
+
+    UCA0TXBUF = *txBlock;
+    txBlock++;
+    if (--txBlockLength == 0) UART_finishBlock();
+}
+
+/**
+ * The ISR of the USB UART. Moves every received byte from the receive register
+ * into the ring; reading UCA0RXBUF clears the interrupt flag. A byte that finds
+ * the ring full is dropped and counted, as is one the hardware overwrote
+ * before it could be read.
+ *
+ * While the transmit interrupt is enabled, each time the transmit register
+ * empties the next queued byte is written to it. Once the queue runs dry the
+ * transmit interrupt turns itself off until UART_write() queues more. A block
+ * from UART_writeBlock() is sent in its place in the queue. DO NOT
+ * DIRECTLY INVOKE THIS FUNCTION FROM YOUR CODE.
+ */
+void EUSCIA0_IRQHandler() {
+    while (UCA0IFG & UCRXIFG) {
+        if (UCA0STATW & UCOE) rxOverruns++;
+
+        uint8_t data = UCA0RXBUF;
+        uint32_t head = rxHead;
+
+        if (head - rxTail == UART_RX_BUFFER_SIZE) rxOverruns++;
+        else {
+            rxBuffer[head & (UART_RX_BUFFER_SIZE - 1)] = data;
+            rxHead = head + 1;
+        }
+    }
+
+    if ((UCA0IE & UCTXIE) && (UCA0IFG & UCTXIFG)) {
+        uint32_t tail = txTail;
+
+        // UART_write() may have turned the interrupt on during a DMA chunk;
+        // the DMA completion turns it back on when the chunk is done
+        if (txDmaActive) UCA0IE &= ~UCTXIE;
+        else if (txBlock != NULL && tail == txBlockStart) UART_sendBlock();
+        else if (tail == txHead) UCA0IE &= ~UCTXIE;
+        else {
+            UCA0TXBUF = txBuffer[tail & (UART_TX_BUFFER_SIZE - 1)];
+            txTail = tail + 1;
+        }
+    }
+}
+
+/**
+ * Picks the supported rate whose bit time is closest to the measured one, in
+ * cycles of the system clock. Returns false if none is within
+ * UART_AUTOBAUD_TOLERANCE percent.
+ */
+static bool UART_matchBaud(uint32_t bitCycles, UART_Baudrate* baudChoice_p) {
+    uint32_t bestError = UINT32_MAX;
+    int i;
+
+    for (i = 0; i < NUM_BAUD_CHOICES; i++) {
+        uint32_t expected = SYSTEM_CLOCK / baudRates[i];
+        uint32_t error = (bitCycles > expected ? bitCycles - expected : expected - bitCycles) * 100 / expected;
+
+        if (error < bestError) {
+            bestError = error;
+            *baudChoice_p = (UART_Baudrate) i;
+        }
+    }
+
+    return bestError <= UART_AUTOBAUD_TOLERANCE;
+}
+
+/**
+ * The ISR of port 1, which only the receive pin interrupts, at each falling
+ * edge while listening for the host's baudrate. The receive pin cannot be
+ * routed to a Timer_A capture input, so the ISR captures the edge itself: it
+ * reads the system timer (Timer32, which counts down at the system clock)
+ * before anything else, so every stamp is taken the same fixed interrupt
+ * latency after its edge, and the latency drops out of the gaps between them.
+ * It only stores the stamp, taking a few dozen cycles, which keeps it well
+ * inside the 104 cycles between the falls of a sync character at 921600 baud.
+ * An edge whose interrupt is held up by another ISR skews one gap, and the
+ * sync character it belongs to is rejected. DO NOT DIRECTLY INVOKE THIS
+ * FUNCTION FROM YOUR CODE.
+ */
+void PORT1_IRQHandler() {
+    uint32_t now = TIMER32_1->VALUE;
+    uint8_t status = P1IFG & P1IE;
+
+    P1IFG &= ~status;
+
+    if (status & USB_UART_RX_PIN) {
+        uint32_t count = autoBaudCount;
+        autoBaudFalls[count & (AUTOBAUD_RING_SIZE - 1)] = now;
+        autoBaudCount = count + 1;
+    }
+}
+
 /**
  * Initializes the UART module except for the baudrate generation
  * Except for baudrate generation, all other uart configuration should match
@@ -29,6 +235,7 @@ UART UART_construct(uint32_t moduleInstance, uint32_t port, uint32_t pins) {
     uart.moduleInstance = moduleInstance;
     uart.port = port;
     uart.pins = pins;
+    uart.txPolicy = UART_TX_BLOCK;
 
     GPIO_setAsPeripheralModuleFunctionInputPin(uart.port, uart.pins,
                                                GPIO_PRIMARY_MODULE_FUNCTION);
@@ -49,6 +256,117 @@ UART UART_construct(uint32_t moduleInstance, uint32_t port, uint32_t pins) {
     return uart;
 }
 
+/** The second modulation stage (UCBRS) for the fractional part of the clock
+ * divider N, from the eUSCI chapter of the MSP432P4xx technical reference
+ * manual. Each pattern applies from its fraction, given in 1/10000ths, up to
+ * the next one. */
+struct _UART_Modulation {
+    uint16_t fraction;
+    uint8_t pattern;
+};
+static const struct _UART_Modulation modulationTable[] = {
+    {   0, 0x00 }, { 529, 0x01 }, { 715, 0x02 }, { 835, 0x04 }, {1001, 0x08 },
+    {1252, 0x10 }, {1430, 0x20 }, {1670, 0x11 }, {2147, 0x21 }, {2224, 0x22 },
+    {2503, 0x44 }, {3000, 0x25 }, {3335, 0x49 }, {3575, 0x4A }, {3753, 0x52 },
+    {4003, 0x92 }, {4286, 0x53 }, {4378, 0x55 }, {5002, 0xAA }, {5715, 0x6B },
+    {6003, 0xAD }, {6254, 0xB5 }, {6432, 0xB6 }, {6667, 0xD6 }, {7001, 0xB7 },
+    {7147, 0xBB }, {7503, 0xDD }, {7861, 0xED }, {8004, 0xEE }, {8333, 0xBF },
+    {8464, 0xDF }, {8572, 0xEF }, {8751, 0xF7 }, {9004, 0xFB }, {9170, 0xFD },
+    {9288, 0xFE }
+};
+
+/**
+ * Works out the baudrate generator settings for a bit rate, following the
+ * procedure of the technical reference manual. With N = clock / baud, the
+ * oversampling mode is used when N > 16: UCBR is N / 16 and UCBRF the sixteenths
+ * left over. Otherwise UCBR is N itself. Either way UCBRS comes from the
+ * fraction of N. N is kept in 1/10000ths so that no floating point is needed.
+ */
+static void UART_computeBaud(UART_Config* config_p, uint32_t clock, uint32_t baud) {
+    uint64_t n = (uint64_t) clock * 10000 / baud;
+    uint32_t fraction = n % 10000;
+    int i;
+
+    if (n > 16 * 10000) {
+        config_p->overSampling   = EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION;
+        config_p->clockPrescalar = n / (16 * 10000);
+        config_p->firstModReg    = (n % (16 * 10000)) / 10000;
+    }
+    else {
+        config_p->overSampling   = EUSCI_A_UART_LOW_FREQUENCY_BAUDRATE_GENERATION;
+        config_p->clockPrescalar = n / 10000;
+        config_p->firstModReg    = 0;
+    }
+
+    for (i = sizeof(modulationTable) / sizeof(modulationTable[0]) - 1; modulationTable[i].fraction > fraction; i--) ;
+    config_p->secondModReg = modulationTable[i].pattern;
+}
+
+uint32_t UART_getBaudRate(UART_Baudrate baudChoice) {
+    return baudRates[baudChoice];
+}
+
+/**
+ * Takes the receive pin away from the UART as a plain input and arms its
+ * falling edge interrupt; PORT1_IRQHandler() does the measuring.
+ */
+void UART_startAutoBaud(UART* uart_p) {
+    autoBaudCount = 0;
+    autoBaudListening = true;
+
+    GPIO_setAsInputPin(USB_UART_PORT, USB_UART_RX_PIN);
+    GPIO_interruptEdgeSelect(USB_UART_PORT, USB_UART_RX_PIN, GPIO_HIGH_TO_LOW_TRANSITION);
+    GPIO_clearInterruptFlag(USB_UART_PORT, USB_UART_RX_PIN);
+    GPIO_enableInterrupt(USB_UART_PORT, USB_UART_RX_PIN);
+    Interrupt_enableInterrupt(INT_PORT1);
+}
+
+/**
+ * Checks whether the latest AUTOBAUD_FALLS falls are those of one sync
+ * character: its start bit and the falls into bits 1, 3, 5 and 7, two bit
+ * times apart. Back-to-back sync characters keep that spacing across the stop
+ * bit too, so any run of their falls will do; otherwise a run straddling two
+ * characters is rejected and a later call tries again. The four gaps must
+ * agree, and their total of eight bit times gives the bit time.
+ *
+ * A found rate is handed over once, and the pin stops interrupting. Whatever
+ * was received before listening began was sent at the old rate, so it is
+ * thrown away with it.
+ */
+bool UART_getAutoBaud(UART* uart_p, UART_Baudrate* baudChoice_p) {
+    uint32_t falls[AUTOBAUD_FALLS];
+    uint32_t count;
+    int i;
+
+    if (!autoBaudListening) return false;
+
+    // Copy the latest falls out without the ISR adding one halfway through
+    bool wasDisabled = Interrupt_disableMaster();
+    count = autoBaudCount;
+    if (count >= AUTOBAUD_FALLS) {
+        for (i = 0; i < AUTOBAUD_FALLS; i++)
+            falls[i] = autoBaudFalls[(count - AUTOBAUD_FALLS + i) & (AUTOBAUD_RING_SIZE - 1)];
+    }
+    if (!wasDisabled) Interrupt_enableMaster();
+
+    if (count < AUTOBAUD_FALLS) return false;
+
+    // Timer32 counts down, so earlier stamps are larger
+    uint32_t span = falls[0] - falls[AUTOBAUD_FALLS - 1];
+    for (i = 0; i < AUTOBAUD_FALLS - 1; i++) {
+        uint32_t gap = falls[i] - falls[i + 1];
+        if (gap * (AUTOBAUD_FALLS - 1) * 100 < span * (100 - UART_AUTOBAUD_TOLERANCE) ||
+            gap * (AUTOBAUD_FALLS - 1) * 100 > span * (100 + UART_AUTOBAUD_TOLERANCE)) return false;
+    }
+
+    if (!UART_matchBaud(span / 8, baudChoice_p)) return false;
+
+    GPIO_disableInterrupt(USB_UART_PORT, USB_UART_RX_PIN);
+    autoBaudCount = 0;
+    rxTail = rxHead;
+    return true;
+}
+
 /**
  * (Re)initializes and (re)enable the UART module to use a desired baudrate.
  *
@@ -62,28 +380,36 @@ void UART_SetBaud_Enable(UART* uart_p, UART_Baudrate baudChoice) {
     // clock is 48MHz.
     uart_p->config.selectClockSource = EUSCI_A_UART_CLOCKSOURCE_SMCLK;
 
-    // Fortunately for us, for all the baudrates we are working with with f =
-    // 48MHz, we use oversampling mode N>16
-    uart_p->config.overSampling = EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION;
+    // The divider and modulation settings are worked out for the rate rather
+    // than looked up, so any rate the clock can reach may be added to the list
+    UART_computeBaud(&uart_p->config, SYSTEM_CLOCK, baudRates[baudChoice]);
 
-    // When using the baudChoice to index the array, we are effectively saying
-    // that different baudrate choices correspond with different numbers
-    // without requiring excessive amounts of if-statements.
-    // TODO: fill these tables such that they work with the proper baudChoice. The
-    // first column is given for 9600 BPS
-    uint32_t clockPrescalerMapping[NUM_BAUD_CHOICES] = {312, 156, 78, 52};      // UCBR
-    uint32_t firstModRegMapping[NUM_BAUD_CHOICES]    = {8,   4,   2,  1};       // UCBRF
-    uint32_t secondModRegMapping[NUM_BAUD_CHOICES]   = {0,   0,   0,  0x25};    // UCBRS
+    // Let anything still queued go out at the old baudrate first, instead of
+    // being cut off by the reset
+    UART_flush(uart_p);
 
-    // TODO: Replace 0s with the correct statement. Use line 71 as your guide
-    uart_p->config.clockPrescalar = clockPrescalerMapping[baudChoice];
-    uart_p->config.firstModReg    = firstModRegMapping[baudChoice];
-    uart_p->config.secondModReg   = secondModRegMapping[baudChoice];
+    // Stop listening for the host's baudrate, handing the receive pin back to
+    // the UART
+    if (autoBaudListening) {
+        GPIO_disableInterrupt(USB_UART_PORT, USB_UART_RX_PIN);
+        GPIO_setAsPeripheralModuleFunctionInputPin(USB_UART_PORT, USB_UART_RX_PIN, GPIO_PRIMARY_MODULE_FUNCTION);
+        autoBaudListening = false;
+    }
 
     // TODO: initialize and enable uart instance (refer to the basic_example_UART
     // project for guidance)
     UART_initModule(uart_p->moduleInstance, &uart_p->config);
     UART_enableModule(uart_p->moduleInstance);
+
+    // Initializing the module clears its interrupt enables, so receiving by
+    // interrupt has to be turned back on after every baudrate change
+    if (uart_p->moduleInstance == USB_UART_INSTANCE) {
+#if UART_USE_DMA
+        Dma_init();
+#endif
+        UART_enableInterrupt(uart_p->moduleInstance, EUSCI_A_UART_RECEIVE_INTERRUPT);
+        Interrupt_enableInterrupt(INT_EUSCIA0);
+    }
 }
 
 // Not-a-real TODO: read this function and its comment to learn how to implement
@@ -91,7 +417,7 @@ void UART_SetBaud_Enable(UART* uart_p, UART_Baudrate baudChoice) {
 // name of the instance from the basic example where we used no HAL
 /**
  * Determines if the user has sent a UART data packet to the board by checking
- * the interrupt status of the proper system UART module.
+ * whether the receive ISR has queued any bytes that were not yet taken.
  *
  * @param uart_p: The pointer to the UART instance with which to handle our
  * operations.
@@ -99,45 +425,146 @@ void UART_SetBaud_Enable(UART* uart_p, UART_Baudrate baudChoice) {
  * @return true if the user has entered a character, and false otherwise
  */
 bool UART_hasChar(UART* uart_p) {
-    uint8_t interruptStatus = UART_getInterruptStatus(
-            uart_p->moduleInstance, EUSCI_A_UART_RECEIVE_INTERRUPT_FLAG);
-
-    return (interruptStatus == EUSCI_A_UART_RECEIVE_INTERRUPT_FLAG);
+    return rxHead != rxTail;
 }
 
-// TODO: Complete the UART_getChar() function.
-// TODO: Write a descriptive comment explaining HOW the function is implemented.
-//       In the implementation file, prefer explaining HOW the function is
-//       implemented over simply WHAT the function does.
+/**
+ * Takes the oldest byte out of the receive ring. The slot is read before
+ * rxTail moves past it, so the ISR cannot reuse it too early.
+ *
+ * @return the character, or 0 if nothing has been received
+ */
 char UART_getChar(UART* uart_p) {
-    // TODO: change this
-    return UART_receiveData(uart_p->moduleInstance);
+    uint32_t tail = rxTail;
+    if (rxHead == tail) return 0;
+
+    char c = rxBuffer[tail & (UART_RX_BUFFER_SIZE - 1)];
+    rxTail = tail + 1;
+    return c;
 }
 
-// TODO: Complete the UART_canSend() function.
-// TODO: Write a descriptive comment explaining HOW the function is implemented.
-//       In the implementation file, prefer explaining HOW the function is
-//       implemented over simply WHAT the function does.
-bool UART_canSend(UART* uart_p) {
-    // TODO: change this
-    uint8_t interruptStatus = UART_getInterruptStatus(
-          uart_p->moduleInstance, EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG);
+/**
+ * Copies out whatever the ring held when the call began, up to n bytes, and
+ * frees all of it with a single move of rxTail.
+ */
+size_t UART_read(UART* uart_p, char* buf, size_t n) {
+    uint32_t tail = rxTail;
+    uint32_t available = rxHead - tail;
+    size_t i;
 
-    return (interruptStatus == EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG);
+    if (n > available) n = available;
+    for (i = 0; i < n; i++) buf[i] = rxBuffer[(tail + i) & (UART_RX_BUFFER_SIZE - 1)];
+
+    rxTail = tail + n;
+    return n;
 }
 
-// TODO: Complete the UART_sendChar() function.
-// TODO: Write a descriptive comment explaining HOW the function is implemented.
-//       In the implementation file, prefer explaining HOW the function is
-//       implemented over simply WHAT the function does.
-void UART_sendChar(UART* uart_p, char c) {
-    // TODO: add some lines here
+uint32_t UART_getOverruns(UART* uart_p) {
+    return rxOverruns;
+}
 
-    UART_transmitData(uart_p->moduleInstance, c);
+/**
+ * Checks whether the transmit ring has room for at least one more byte. The
+ * ISR only ever frees room, so the answer cannot turn false before the caller
+ * acts on it.
+ */
+bool UART_canSend(UART* uart_p) {
+    return txHead - txTail < UART_TX_BUFFER_SIZE;
 }
 
+/**
+ * Queues one character, following the UART's transmit policy when the ring is
+ * full.
+ */
+void UART_sendChar(UART* uart_p, char c) {
+    UART_write(uart_p, &c, 1);
+}
+
+/**
+ * Queues a whole string with a single UART_write(), so the length is only
+ * worked out once.
+ */
 void UART_sendString(UART* uart_p, char string[]) {
-    int i; for (i = 0; i < strlen(string); i++) {
-        UART_sendChar(uart_p, string[i]);
+    UART_write(uart_p, string, strlen(string));
+}
+
+/**
+ * Copies as much as the policy allows into the transmit ring, publishes it
+ * with one move of txHead and then enables the transmit interrupt. If the
+ * transmit register is already empty the interrupt fires right away and sends
+ * the first byte. Under UART_TX_BLOCK the copy is done in as many pieces as it
+ * takes, waiting for the ISR to free room between them.
+ */
+size_t UART_write(UART* uart_p, const char* buf, size_t n) {
+    size_t queued = 0;
+
+    while (queued < n) {
+        uint32_t head = txHead;
+        uint32_t space = UART_TX_BUFFER_SIZE - (head - txTail);
+        size_t count = n - queued;
+
+        if (count > space) {
+            if (uart_p->txPolicy == UART_TX_DROP) break;
+            count = space;
+        }
+
+        size_t i; for (i = 0; i < count; i++) {
+            txBuffer[(head + i) & (UART_TX_BUFFER_SIZE - 1)] = buf[queued + i];
+        }
+        txHead = head + count;
+        queued += count;
+
+        if (count > 0) UCA0IE |= UCTXIE;
+
+        uint32_t used = txHead - txTail;
+        if (used > txHighWater) txHighWater = used;
+
+        if (uart_p->txPolicy != UART_TX_BLOCK) break;
     }
+
+    return queued;
+}
+
+/**
+ * Records where in the ring the block belongs and publishes it by setting
+ * txBlock last, then enables the transmit interrupt, which sends it once the
+ * ring has caught up to that point.
+ */
+bool UART_writeBlock(UART* uart_p, const char* buf, size_t n, UART_TxDone done, void* owner_p) {
+    while (txBlock != NULL) {
+        if (uart_p->txPolicy != UART_TX_BLOCK) return false;
+    }
+
+    if (n == 0) {
+        if (done != NULL) done(owner_p);
+        return true;
+    }
+
+    txBlockStart  = txHead;
+    txBlockLength = n;
+    txBlockDone   = done;
+    txBlockOwner  = owner_p;
+    txBlock       = buf;
+
+    UCA0IE |= UCTXIE;
+    return true;
+}
+
+void UART_setTxPolicy(UART* uart_p, UART_TxPolicy policy) {
+    uart_p->txPolicy = policy;
+}
+
+/**
+ * Waits for the ISR to empty the ring and finish the block, and then for the
+ * last byte to leave the shift register.
+ */
+void UART_flush(UART* uart_p) {
+    while (txHead != txTail || txBlock != NULL)
+        ;
+    while (UCA0STATW & UCBUSY)
+        ;
+}
+
+uint32_t UART_getTxHighWater(UART* uart_p) {
+    return txHighWater;
 }
@@ -30,6 +30,10 @@
                            // because many students miss the parentheses
 #define USB_UART_INSTANCE EUSCI_A0_BASE
 
+// The receive pin of the USB UART, watched on its own while detecting the
+// host's baudrate
+#define USB_UART_RX_PIN GPIO_PIN2
+
 // An enum outlining what baud rates the UART_construct() function can use in
 // its initialization.
 enum _UART_Baudrate {
@@ -37,10 +41,70 @@ enum _UART_Baudrate {
   BAUD_19200,
   BAUD_38400,
   BAUD_57600,
+  BAUD_115200,
+  BAUD_230400,
+  BAUD_460800,
+  BAUD_921600,
   NUM_BAUD_CHOICES
 };
 typedef enum _UART_Baudrate UART_Baudrate;
 
+// Bytes received on USB_UART_INSTANCE are taken out of the receive register by
+// an interrupt as soon as they arrive and queued in a ring of this many bytes,
+// so none are lost while the main loop is busy drawing. Must be a power of two.
+#define UART_RX_BUFFER_SIZE 256
+
+#if (UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0
+#error UART_RX_BUFFER_SIZE must be a power of two
+#endif
+
+// Bytes sent on USB_UART_INSTANCE are queued in a ring of this many bytes and
+// sent by the transmit interrupt, so sending a prompt does not hold up the
+// main loop for the time it takes to go out. Must be a power of two.
+#define UART_TX_BUFFER_SIZE 512
+
+#if (UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0
+#error UART_TX_BUFFER_SIZE must be a power of two
+#endif
+
+// Set to 1 to send blocks queued with UART_writeBlock() through the uDMA
+// controller, or to 0 to send them from the transmit interrupt like the ring.
+#define UART_USE_DMA 1
+
+// uDMA trigger source for EUSCI_A0 transmit, on the channel shared with the
+// LCD (see <HAL/Dma.h>)
+#define UART_DMA_CHANNEL_MAPPING DMA_CH0_EUSCIA0TX
+
+// A block is sent by DMA in chunks of at most this many bytes. The channel is
+// handed back between chunks, and once the LCD has been turned away from it
+// the next chunk's worth of the block is sent by the CPU instead, so that the
+// LCD's next transfer finds the channel free.
+#define UART_DMA_CHUNK_BYTES 32
+
+// Blocks shorter than this are sent from the transmit interrupt
+#define UART_DMA_MIN_BYTES 8
+
+// Automatic baudrate detection: the host sends this character, whose bits
+// alternate so that its line falls every two bit times, until it sees the
+// board's confirmation
+#define UART_AUTOBAUD_SYNC 'U'
+
+// A measured bit time is taken for a supported rate when it is within this
+// many percent of that rate's bit time
+#define UART_AUTOBAUD_TOLERANCE 12
+
+// What UART_write() does with text that does not fit in the transmit ring
+enum _UART_TxPolicy {
+  UART_TX_BLOCK,     // Wait for the interrupt to make room, then queue it all
+  UART_TX_DROP,      // Queue none of it unless all of it fits
+  UART_TX_TRUNCATE   // Queue as much as fits and drop the rest
+};
+typedef enum _UART_TxPolicy UART_TxPolicy;
+
+// Called, from an interrupt, once every byte of a block passed to
+// UART_writeBlock() has been handed to the UART, so the block may be reused
+typedef void (*UART_TxDone)(void* owner_p);
+
 // TODO: Write an overview explanation of what this UART struct does, and how it
 //       interacts with the functions below. Consult <HAL/Button.h> and
 //       <HAL/LED.h> for examples on how to do this.
@@ -50,6 +114,8 @@ struct _UART {
   uint32_t moduleInstance;
   uint32_t port;
   uint32_t pins;
+
+  UART_TxPolicy txPolicy;
 };
 typedef struct _UART UART;
 
@@ -59,17 +125,64 @@ UART UART_construct(uint32_t moduleInstance, uint32_t port, uint32_t pins);
 // Sets the baudrate and enables a UART based on the given baudrate enum
 void UART_SetBaud_Enable(UART*, UART_Baudrate baudrate);
 
+// Returns the bit rate of a baudrate choice, in bits per second
+uint32_t UART_getBaudRate(UART_Baudrate baudChoice);
+
+// Stops receiving and instead listens for UART_AUTOBAUD_SYNC characters to
+// measure the host's baudrate. Transmitting carries on at the current rate.
+// UART_SetBaud_Enable() stops listening.
+void UART_startAutoBaud(UART* uart_p);
+
+// Returns true, once, when listening has found a supported baudrate, which is
+// stored in baudChoice_p. The timing of the received edges is checked here
+// rather than in the interrupt, so call it once per super-loop while
+// listening. The UART is left listening until the caller enables the found
+// rate with UART_SetBaud_Enable().
+bool UART_getAutoBaud(UART* uart_p, UART_Baudrate* baudChoice_p);
+
 // TODO: Write a comment which explains what each of these functions does. In
 // the
 //       header, prefer explaining WHAT the function does, as opposed to HOW it
 //       is implemented.
 bool UART_hasChar(UART* uart_p);
 char UART_getChar(UART* uart_p);
+
+// Takes up to n received characters into buf, without waiting for more to
+// arrive, and returns how many were taken
+size_t UART_read(UART* uart_p, char* buf, size_t n);
+
+// Returns how many received characters were dropped because the receive ring
+// was full, or because the hardware was overrun before the interrupt ran
+uint32_t UART_getOverruns(UART* uart_p);
+
 bool UART_canSend(UART* uart_p);
 void UART_sendChar(UART* uart_p, char c);
 
 void UART_sendString(UART* uart_p, char string[]);
 
+// Queues n characters to be sent and returns without waiting for them to go
+// out, unless the policy is UART_TX_BLOCK and the queue is full. Returns how
+// many characters were queued.
+size_t UART_write(UART* uart_p, const char* buf, size_t n);
+
+// Queues a block of n characters to be sent straight from buf, which may be a
+// const string in flash, after everything already queued and before anything
+// queued later. buf must stay unchanged until done is called; done may be
+// NULL. Only one block can be waiting at a time: if one already is, this waits
+// for it under UART_TX_BLOCK and otherwise returns false without queuing.
+bool UART_writeBlock(UART* uart_p, const char* buf, size_t n, UART_TxDone done, void* owner_p);
+
+// Chooses what UART_write() does when the transmit queue is full. UARTs are
+// constructed with UART_TX_BLOCK.
+void UART_setTxPolicy(UART* uart_p, UART_TxPolicy policy);
+
+// Waits until every queued character and block has been sent
+void UART_flush(UART* uart_p);
+
+// Returns the most characters that have ever been waiting in the transmit
+// queue at once
+uint32_t UART_getTxHighWater(UART* uart_p);
+
 // Updates the UART baudrate to use the new baud choice.
 void UART_updateBaud(UART* uart_p, UART_Baudrate baudChoice);
 
@@ -11,9 +11,30 @@
 
 /* HAL and Application includes */
 #include <Application.h>
+#include <HAL/Benchmark.h>
 #include <HAL/HAL.h>
 #include <HAL/Timer.h>
 
+// The static parts of the title and settings screens are recorded into display
+// lists the first time they are drawn and replayed on every later visit.
+static uint8_t titleScreenData[1024];
+static Crystalfontz128x128_DisplayList titleScreenList = { titleScreenData, sizeof(titleScreenData), 0, false };
+
+static uint8_t settingsScreenData[2048];
+static Crystalfontz128x128_DisplayList settingsScreenList = { settingsScreenData, sizeof(settingsScreenData), 0, false };
+
+// What the baud rate pop-up covers on the game screen
+static uint16_t popupPixels[POPUP_PIXELS];
+
+// The list of move formats which ends every move prompt. It never changes, so
+// it is sent straight out of flash instead of being copied into the UART queue.
+static const char moveFormats[] = "                    \rXYU\n\
+                    \rXYD\n\
+                    \rXYL\n\
+                    \rXYR\n\
+                    \rX1XY1X2Y2\n\
+                    \rPress enter to submit your move: ";
+
 // Non-blocking check. Whenever Launchpad S1 is pressed, LED1 turns on.
 static void InitNonBlockingLED() {
     GPIO_setAsOutputPin(GPIO_PORT_P1, GPIO_PIN0);
@@ -28,6 +49,25 @@ static void PollNonBlockingLED() {
     }
 }
 
+// Lights an RGB LED in one of the colors used to show the baud rate: 0 off,
+// 1 red, 2 green, 3 blue, 4 white.
+static void ShowBaudColor(LED* red_p, LED* green_p, LED* blue_p, int color) {
+    if (color == 1 || color == 4) LED_turnOn(red_p);
+    if (color == 2 || color == 4) LED_turnOn(green_p);
+    if (color == 3 || color == 4) LED_turnOn(blue_p);
+}
+
+// Reports over UART how long it took from reset until the first frame was
+// fully on the panel.
+static void ReportBootTime(HAL* hal_p, SWTimer* bootTimer_p) {
+    GFX_flush(&hal_p->gfx);
+
+    char report[48];
+    sprintf(report, "First frame after %lu us\r\n",
+            (unsigned long)SWTimer_elapsedTimeUS(bootTimer_p));
+    UART_sendString(&hal_p->uart, report);
+}
+
 /**
  * The main entry point of your project. The main function should immediately
  * stop the Watchdog timer, call the Application constructor, and then
@@ -47,6 +87,10 @@ int main(void) {
     // software timers to time their measurements properly.
     InitSystemTiming();
 
+    // Measures the time from reset to the first frame on the LCD
+    SWTimer bootTimer = SWTimer_construct(0);
+    SWTimer_start(&bootTimer);
+
     // Initialize the main Application object and HAL object
     HAL hal = HAL_construct();
     Application app = Application_construct();
@@ -54,7 +98,12 @@ int main(void) {
     // Do not remove this line. This is your non-blocking check.
     InitNonBlockingLED();
 
+#if GFX_BENCHMARK
+    Benchmark_run(&hal);
+#endif
+
     Application_showTitleScreen(&hal.gfx);
+    ReportBootTime(&hal, &bootTimer);
 
     // Main super-loop! In a polling architecture, this function should call
     // your main FSM function over and over.
@@ -100,9 +149,13 @@ Application Application_construct() {
     app.players[1].color = GRAPHICS_COLOR_BLUE;
     app.numTurn          = 0;
     app.numPlayer        = 0;
+    app.popupShown       = false;
+    app.autoBaudTimer    = SWTimer_construct(AUTO_BAUD_HOLD_MS);
+    app.autoBaudArmed    = false;
 
     app.boxes.coordinates[COORDINATES_FORMAT_L] = '\0';
     app.boxes.coordinates[COORDINATES_FORMAT_N] = '\0';
+    app.boxes.numCoordinates = 0;
 
     return app;
 }
@@ -123,6 +176,24 @@ void Application_loop(Application* app_p, HAL* hal_p) {
     // baudrate is being set up)
     if (Button_isTapped(&hal_p->boosterpackS2) || app_p->firstCall) {
         Application_updateCommunications(app_p, hal_p);
+        SWTimer_start(&app_p->autoBaudTimer);
+        app_p->autoBaudArmed = true;
+    }
+
+    // Holding BoosterPack S2 down instead listens for the rate the host is
+    // sending at, for hosts which cannot be set to the board's rate
+    if (!Button_isPressed(&hal_p->boosterpackS2)) app_p->autoBaudArmed = false;
+    else if (app_p->autoBaudArmed && SWTimer_expired(&app_p->autoBaudTimer)) {
+        app_p->autoBaudArmed = false;
+        UART_startAutoBaud(&hal_p->uart);
+    }
+
+    if (UART_getAutoBaud(&hal_p->uart, &app_p->baudChoice)) {
+        Application_setCommunications(app_p, hal_p);
+
+        char confirm[32];
+        sprintf(confirm, "Baud rate set to %lu\r\n", (unsigned long) UART_getBaudRate(app_p->baudChoice));
+        UART_sendString(&hal_p->uart, confirm);
     }
 
     switch (app_p->state) {
@@ -142,6 +213,13 @@ void Application_loop(Application* app_p, HAL* hal_p) {
     case GameScreen:
         if (UART_hasChar(&hal_p->uart)) app_p->rxChar = UART_getChar(&hal_p->uart);
         Application_handleGameScreen(app_p, hal_p);
+
+        if (app_p->popupShown && SWTimer_expired(&app_p->popupTimer)) Application_closeBaudPopup(app_p, &hal_p->gfx);
+
+        // Moves only change the board's scene; it is drawn once per frame,
+        // and held back while the pop-up covers part of it
+        if (app_p->state == GameScreen && !app_p->popupShown && GFX_isFrameStart(&hal_p->gfx))
+            Board_render(&app_p->board, &hal_p->gfx);
         break;
 
     case ResultsScreen:
@@ -202,6 +280,16 @@ void Application_handleSettingsScreen(Application* app_p, HAL* hal_p) {
 
 void Application_handleGameScreen(Application* app_p, HAL* hal_p) {
 
+    // JSB Steps the Cursor to the Next Free Line, BB1 Plays the Line Under It
+    if (app_p->numTurn < app_p->settings.maxTurns) {
+        if (Button_isTapped(&hal_p->boosterpackJS)) {
+            Board_setCursor(&app_p->board, Board_nextFreeEdge(&app_p->board, app_p->board.scene.cursor));
+        }
+        else if (Button_isTapped(&hal_p->boosterpackS1) && app_p->board.scene.cursor != BOARD_NO_CURSOR) {
+            Application_playEdge(app_p, hal_p, app_p->board.scene.cursor);
+        }
+    }
+
     if      (app_p->numTurn < app_p->settings.maxTurns) Application_updateGameScreen(app_p, hal_p);
     else if (app_p->numTurn++ == app_p->settings.maxTurns) {
         char instr[] = "Press BB1 to end the game";
@@ -216,14 +304,20 @@ void Application_handleGameScreen(Application* app_p, HAL* hal_p) {
 
 void Application_showTitleScreen(GFX* gfx_p) {
 
+    if (GFX_replay(gfx_p, &titleScreenList)) return;
+
+    GFX_startRecording(gfx_p, &titleScreenList);
+
     GFX_clear(gfx_p);
 
-    GFX_print(gfx_p, "Dots and Boxes", 2, 1);
+    GFX_print(gfx_p, "Dots and Boxes", GFX_FIXED(2), GFX_FIXED(1));
+
+    GFX_print(gfx_p, "Victoria Chin", GFX_FIXED(5), GFX_FIXED(1));
 
-    GFX_print(gfx_p, "Victoria Chin", 5, 1);
+    GFX_print(gfx_p, "LB1: Play Game",    GFX_FIXED(7), GFX_FIXED(1));
+    GFX_print(gfx_p, "LB2: Instructions", GFX_FIXED(8), GFX_FIXED(1));
 
-    GFX_print(gfx_p, "LB1: Play Game",    7, 1);
-    GFX_print(gfx_p, "LB2: Instructions", 8, 1);
+    GFX_stopRecording(gfx_p);
 
 }
 
@@ -242,50 +336,48 @@ void Application_showInstructionsScreen(GFX* gfx_p) {
 */
 void Application_showSettingsScreen(Application* app_p, GFX* gfx_p) {
 
-    GFX_clear(gfx_p);
+    // Everything but the current settings and the cursor is static
+    if (!GFX_replay(gfx_p, &settingsScreenList)) {
+        GFX_startRecording(gfx_p, &settingsScreenList);
+
+        GFX_clear(gfx_p);
+
+        GFX_print(gfx_p, "Settings", GFX_FIXED(2), GFX_FIXED(6.5));
+
+        char* instr[] = { "Tap JSB to switch",
+                          "between Width, Height",
+                          "and PLAY",
+                          "Tap BB1 to change #",
+                          "or confirm settings",
+                          "to play game"};
 
-    GFX_print(gfx_p, "Settings", 2, 6.5);
+        int length = (int)(sizeof(instr) / sizeof(instr[0]));
+        GFX_printTextRows(gfx_p, instr, length, GFX_FIXED(4), GFX_FIXED(0));
 
-    char* instr[] = { "Tap JSB to switch",
-                      "between Width, Height",
-                      "and PLAY",
-                      "Tap BB1 to change #",
-                      "or confirm settings",
-                      "to play game"};
+        GFX_print(gfx_p, "Width:", GFX_FIXED(11), GFX_FIXED(1));
+        GFX_print(gfx_p, "Height:", GFX_FIXED(12), GFX_FIXED(1));
+        GFX_print(gfx_p, "PLAY", GFX_FIXED(14), GFX_FIXED(8.5));
 
-    int length = (int)(sizeof(instr) / sizeof(instr[0]));
-    GFX_printTextRows(gfx_p, instr, length, 4, 0);
+        GFX_stopRecording(gfx_p);
+    }
 
     char num[] = "0";
 
     num[0] += app_p->settings.width;
-    GFX_print(gfx_p, "Width:", 11, 1);
-    GFX_print(gfx_p, num, 11, 9);
+    GFX_setText(gfx_p, num, 11, 9);
 
     num[0] = app_p->settings.height + '0';
-    GFX_print(gfx_p, "Height:", 12, 1);
-    GFX_print(gfx_p, num, 12, 9);
-
-    GFX_print(gfx_p, "PLAY", 14, 8.5);
+    GFX_setText(gfx_p, num, 12, 9);
 
-    GFX_print(gfx_p, "*", 11, 13.5);
+    GFX_setText(gfx_p, "*", 11, 14);
 
 }
 
 void Application_showGameScreen(Application* app_p, GFX* gfx_p) {
 
-    GFX_clear(gfx_p);
-
-    int spaceWidth  = 128 / app_p->settings.width - 1;
-    int spaceHeight = 128 / app_p->settings.height - 1;
-
-    float i, j; for (i = 0.5; i <= app_p->settings.width; i++) {
-        for (j = 0.5; j <= app_p->settings.height; j++) {
-            GFX_drawSolidCircle(gfx_p, 2.5 + spaceWidth * i, 2.5 + spaceHeight * j, 1);
-        }
-    }
-
-    GFX_print(gfx_p, "Game Screen", 15, 5.5);
+    // The board is drawn from its scene at the next frame, so this also
+    // repaints it after anything else has been on the screen
+    Board_invalidate(&app_p->board);
 
 }
 
@@ -295,19 +387,19 @@ void Application_showResultsScreen(Application* app_p, GFX* gfx_p) {
 
     char results[13], winner[] = "Winner: Player  #";
 
-    GFX_print(gfx_p, "Results Screen", 1, 3.5);
+    GFX_print(gfx_p, "Results Screen", GFX_FIXED(1), GFX_FIXED(3.5));
 
     sprintf(results, "Player %i: %i", 1, app_p->players[0].boxesWon);
-    GFX_print(gfx_p, results, 3, 1);
+    GFX_print(gfx_p, results, GFX_FIXED(3), GFX_FIXED(1));
 
     sprintf(results, "Player %i: %i", 2, app_p->players[1].boxesWon);
-    GFX_print(gfx_p, results, 4, 1);
+    GFX_print(gfx_p, results, GFX_FIXED(4), GFX_FIXED(1));
 
-    if (app_p->players[0].boxesWon == app_p->players[1].boxesWon) GFX_print(gfx_p, "TIE", 6, 1);
+    if (app_p->players[0].boxesWon == app_p->players[1].boxesWon) GFX_print(gfx_p, "TIE", GFX_FIXED(6), GFX_FIXED(1));
     else {
         char player = (app_p->players[0].boxesWon > app_p->players[1].boxesWon) ? '1' : '2';
         winner[16] = player;
-        GFX_print(gfx_p, winner, 6, 1);
+        GFX_print(gfx_p, winner, GFX_FIXED(6), GFX_FIXED(1));
     }
 
 }
@@ -319,21 +411,21 @@ void Application_updateCursor(Application* app_p, GFX* gfx_p) {
     switch (app_p->cursorState) {
 
     case Cursor_0:
-        GFX_eraseText(gfx_p, asterick, 12, 13.5);
-        GFX_eraseText(gfx_p, asterick, 14, 13.5);
-        GFX_print(gfx_p, asterick, 11, 13.5);
+        GFX_clearText(gfx_p, 12, 14, 1);
+        GFX_clearText(gfx_p, 14, 14, 1);
+        GFX_setText(gfx_p, asterick, 11, 14);
         break;
 
     case Cursor_1:
-        GFX_eraseText(gfx_p, asterick, 11, 13.5);
-        GFX_eraseText(gfx_p, asterick, 14, 13.5);
-        GFX_print(gfx_p, asterick, 12, 13.5);
+        GFX_clearText(gfx_p, 11, 14, 1);
+        GFX_clearText(gfx_p, 14, 14, 1);
+        GFX_setText(gfx_p, asterick, 12, 14);
         break;
 
     case Cursor_2:
-        GFX_eraseText(gfx_p, asterick, 11, 13.5);
-        GFX_eraseText(gfx_p, asterick, 12, 13.5);
-        GFX_print(gfx_p, asterick, 14, 13.5);
+        GFX_clearText(gfx_p, 11, 14, 1);
+        GFX_clearText(gfx_p, 12, 14, 1);
+        GFX_setText(gfx_p, asterick, 14, 14);
         break;
 
     default: break;
@@ -352,14 +444,14 @@ void Application_updateSettings(Application* app_p, GFX* gfx_p) {
     case Cursor_0:
         app_p->settings.width = RangedCircularIncrement(app_p->settings.width, MIN_DIM, MAX_DIM);
         setting[0] += app_p->settings.width;
-        GFX_print(gfx_p, setting, 11, 9);
+        GFX_setText(gfx_p, setting, 11, 9);
         break;
 
     // Increment Height
     case Cursor_1:
         app_p->settings.height = RangedCircularIncrement(app_p->settings.height, MIN_DIM, MAX_DIM);
         setting[0] += app_p->settings.height;
-        GFX_print(gfx_p, setting, 12, 9);
+        GFX_setText(gfx_p, setting, 12, 9);
         break;
 
     // Display Game Screen
@@ -368,6 +460,7 @@ void Application_updateSettings(Application* app_p, GFX* gfx_p) {
         app_p->settings.maxTurns = app_p->settings.width  * (app_p->settings.height - 1) +
                                    app_p->settings.height * (app_p->settings.width - 1);
         app_p->boxes.boxesToWin  = (app_p->settings.width - 1) * (app_p->settings.height - 1);
+        app_p->boxes.numCoordinates = 0;
 
         int i, j = 1;
         
@@ -381,6 +474,13 @@ void Application_updateSettings(Application* app_p, GFX* gfx_p) {
             }
             topLine += app_p->settings.width;
         }
+        uint32_t colors[MAX_PLAYERS];
+        for (i = 0; i < MAX_PLAYERS; i++) {
+            app_p->players[i].boxesWon = 0;
+            colors[i] = app_p->players[i].color;
+        }
+        Board_start(&app_p->board, app_p->settings.width, app_p->settings.height, colors);
+        Board_setTurn(&app_p->board, app_p->numPlayer);
         Application_showGameScreen(app_p, gfx_p);
 
         break;
@@ -412,13 +512,7 @@ void Application_updateGameScreen(Application* app_p, HAL* hal_p) {
 void Application_sendFirstQuestion(Application* app_p, UART* uart_p) {
 
     char player[] = "Player #";
-    char instr[] = ", please enter a number from 0-# for X and 0-# for Y with any of the following formats:\n\
-                    \rXYU\n\
-                    \rXYD\n\
-                    \rXYL\n\
-                    \rXYR\n\
-                    \rX1XY1X2Y2\n\
-                    \rPress enter to submit your move: ";
+    char instr[] = ", please enter a number from 0-# for X and 0-# for Y with any of the following formats:\n";
 
     player[7] = app_p->numPlayer + 1 + '0';
     UART_sendString(uart_p, player);
@@ -426,27 +520,23 @@ void Application_sendFirstQuestion(Application* app_p, UART* uart_p) {
     instr[31] = app_p->settings.width  - 1 + '0';
     instr[45] = app_p->settings.height - 1 + '0';
     UART_sendString(uart_p, instr);
+    UART_writeBlock(uart_p, moveFormats, sizeof(moveFormats) - 1, NULL, NULL);
 
 }
 
 void Application_sendInvalidCoordinates(Application* app_p, UART* uart_p) {
 
-    char instr[] = "Please enter a number from 0-# for X and 0-# for Y with any of the following formats:\n\
-                    \rXYU\n\
-                    \rXYD\n\
-                    \rXYL\n\
-                    \rXYR\n\
-                    \rX1XY1X2Y2\n\
-                    \rPress enter to submit your move: ";
+    char instr[] = "Please enter a number from 0-# for X and 0-# for Y with any of the following formats:\n";
     instr[29] = app_p->settings.width - 1 + '0';
     instr[43] = app_p->settings.height - 1 + '0';
     UART_sendString(uart_p, instr);
+    UART_writeBlock(uart_p, moveFormats, sizeof(moveFormats) - 1, NULL, NULL);
 
 }
 
 void Application_receiveCoordinates(Application* app_p, HAL* hal_p) {
 
-    static int i = 0;
+    int i = app_p->boxes.numCoordinates;
 
     // Accept the Valid Number of Characters
     if (i < COORDINATES_LEN) {
@@ -484,6 +574,7 @@ void Application_receiveCoordinates(Application* app_p, HAL* hal_p) {
     }
 
 
+    app_p->boxes.numCoordinates = i;
     app_p->rxChar = 1;
 
 }
@@ -516,25 +607,15 @@ void Application_interpretCoordinates(Application* app_p, HAL* hal_p) {
 
     if (valid && Application_checkCoordinate(app_p, &hal_p->gfx)){
 
-        GFX_setForeground(&hal_p->gfx, app_p->players[app_p->numPlayer].color);
-
-        int spaceWidth = 128 / app_p->settings.width - 1;
-        int spaceHeight = 128 / app_p->settings.height - 1;
-        float x = app_p->boxes.coordinates[X1] - '0' + 0.5;
-        float y = app_p->boxes.coordinates[Y1] - '0' + 0.5;
-
-        if (app_p->boxes.coordinates[COORDINATES_FORMAT_L - 1] == 'U')
-            GFX_drawLine(&hal_p->gfx, 2.5 + spaceWidth * y, 2.5 + spaceWidth * y, 2.5 + spaceHeight * x, 2.5 + spaceHeight * (x - 1));
-        else if (app_p->boxes.coordinates[COORDINATES_FORMAT_L - 1] == 'D')
-            GFX_drawLine(&hal_p->gfx, 2.5 + spaceWidth * y, 2.5 + spaceWidth * y, 2.5 + spaceHeight * x, 2.5 + spaceHeight * (x + 1));
-        else if (app_p->boxes.coordinates[COORDINATES_FORMAT_L - 1] == 'L')
-            GFX_drawLine(&hal_p->gfx, 2.5 + spaceWidth * y, 2.5 + spaceWidth * (y - 1), 2.5 + spaceHeight * x, 2.5 + spaceHeight * x);
-        else GFX_drawLine(&hal_p->gfx, 2.5 + spaceWidth * y, 2.5 + spaceWidth * (y + 1), 2.5 + spaceHeight * x, 2.5 + spaceHeight * x);
-
-        GFX_setForeground(&hal_p->gfx, FG_COLOR);
+        Board_setEdge(&app_p->board, Application_edgeIndex(app_p), app_p->numPlayer);
 
         Application_checkBoxWon(app_p);
 
+        Board_setScore(&app_p->board, app_p->numPlayer, app_p->players[app_p->numPlayer].boxesWon);
+        Board_setTurn(&app_p->board, app_p->numPlayer);
+        if (app_p->board.scene.cursor != BOARD_NO_CURSOR)
+            Board_setCursor(&app_p->board, Board_nextFreeEdge(&app_p->board, app_p->board.scene.cursor));
+
         app_p->numTurn++;
         app_p->playState = FirstQuestion;
 
@@ -544,26 +625,61 @@ void Application_interpretCoordinates(Application* app_p, HAL* hal_p) {
 
 }
 
-bool Application_checkCoordinate(Application* app_p, GFX* gfx_p) {
+/**
+ * Plays a move picked with the board cursor by writing it out as coordinates,
+ * the same as if they had been typed over UART. Coordinates partly typed so
+ * far are dropped, so the next typed character starts a new entry.
+ */
+void Application_playEdge(Application* app_p, HAL* hal_p, int edge) {
+
+    if (app_p->boxes.numCoordinates > 0) UART_sendString(&hal_p->uart, "\n\r");   // End the Abandoned Line
+    app_p->boxes.numCoordinates = 0;
+    app_p->boxes.coordinates[COORDINATES_FORMAT_N] = '\0';
+
+    int stride = app_p->settings.width * 2 - 1;
+    int side   = edge % stride;
+
+    app_p->boxes.coordinates[X1] = edge / stride + '0';
+    if (side < app_p->settings.width - 1) {
+        app_p->boxes.coordinates[Y1] = side + '0';
+        app_p->boxes.coordinates[COORDINATES_FORMAT_L - 1] = 'R';
+    }
+    else {
+        app_p->boxes.coordinates[Y1] = side - (app_p->settings.width - 1) + '0';
+        app_p->boxes.coordinates[COORDINATES_FORMAT_L - 1] = 'D';
+    }
+    app_p->boxes.coordinates[COORDINATES_FORMAT_L] = '\0';
+
+    UART_sendString(&hal_p->uart, app_p->boxes.coordinates);
+    UART_sendString(&hal_p->uart, "\n\n\r");
 
-    int side;
+    Application_interpretCoordinates(app_p, hal_p);
+
+}
+
+/**
+ * Returns the board edge named by the coordinates, numbered like linesDrawn.
+ * Each row of dots holds (width * 2 - 1) edges.
+ */
+int Application_edgeIndex(Application* app_p) {
+
+    int stride = app_p->settings.width * 2 - 1;
+    int x = app_p->boxes.coordinates[X1] - '0';
+    int y = app_p->boxes.coordinates[Y1] - '0';
 
     switch (app_p->boxes.coordinates[COORDINATES_FORMAT_L - 1]) {
-    case 'U':
-        side = (app_p->settings.height * 2 - 1) * ((int)(app_p->boxes.coordinates[X1] - '0') - 1) + (int)(app_p->boxes.coordinates[Y1] - '0') + (app_p->settings.width - 1);    // (Height * 2 - 1) * X + Y + (Width - 1)
-        break;
-    case 'D':
-        side = (app_p->settings.height * 2 - 1) * (int)(app_p->boxes.coordinates[X1] - '0') + (int)(app_p->boxes.coordinates[Y1] - '0') + (app_p->settings.width - 1); // (Height * 2 - 1) X +
-        break;
-    case 'L':
-        side = (app_p->settings.height * 2 - 1) * (int)(app_p->boxes.coordinates[X1] - '0') + ((int)(app_p->boxes.coordinates[Y1] - '0') - 1);   // (Height * 2 - 1) * X + (Y-1)
-        break;
-    case 'R':
-        side = (app_p->settings.height * 2 - 1) * (int)(app_p->boxes.coordinates[X1] - '0') + (int)(app_p->boxes.coordinates[Y1] - '0');    // (Height * 2 - 1) * X + Y
-        break;
-    default: break;
+    case 'U': return stride * (x - 1) + y + (app_p->settings.width - 1);  // (Width * 2 - 1) * (X-1) + Y + (Width - 1)
+    case 'D': return stride * x + y + (app_p->settings.width - 1);        // (Width * 2 - 1) * X + Y + (Width - 1)
+    case 'L': return stride * x + (y - 1);                                // (Width * 2 - 1) * X + (Y-1)
+    default:  return stride * x + y;                                      // (Width * 2 - 1) * X + Y
     }
 
+}
+
+bool Application_checkCoordinate(Application* app_p, GFX* gfx_p) {
+
+    int side = Application_edgeIndex(app_p);
+
     bool valid = (app_p->boxes.linesDrawn[side] == 1) ? false : true;
 
     app_p->boxes.linesDrawn[side] = 1;
@@ -590,6 +706,7 @@ void Application_checkBoxWon(Application* app_p) {
         else {
             winCount++;
             app_p->boxes.boxesCompleted[i][BOX_COMPLETED] = 1;
+            Board_setBox(&app_p->board, i, app_p->numPlayer);              // Only Boxes Completed by This Move Get Filled
         }
     }
 
@@ -598,6 +715,40 @@ void Application_checkBoxWon(Application* app_p) {
 
 }
 
+/**
+ * Shows the new baud rate in a pop-up over the board. The first time it
+ * opens, what it covers is saved so that closing it needs no board repaint.
+ */
+void Application_showBaudPopup(Application* app_p, GFX* gfx_p) {
+
+    char text[GFX_TEXT_MAX + 1];
+
+    if (!app_p->popupShown) {
+        GFX_saveUnder(gfx_p, &app_p->popup, popupPixels, POPUP_X0, POPUP_Y0, POPUP_X1, POPUP_Y1);
+        app_p->popupShown = true;
+    }
+
+    GFX_setForeground(gfx_p, FG_COLOR);
+    GFX_fillRect(gfx_p, POPUP_X0, POPUP_Y0, POPUP_X1, POPUP_Y1);
+    GFX_setForeground(gfx_p, BG_COLOR);
+    GFX_fillRect(gfx_p, POPUP_X0 + 1, POPUP_Y0 + 1, POPUP_X1 - 1, POPUP_Y1 - 1);
+    GFX_setForeground(gfx_p, FG_COLOR);
+
+    sprintf(text, "Baud %lu", (unsigned long) UART_getBaudRate(app_p->baudChoice));
+    GFX_print(gfx_p, text, GFX_FIXED(7.5), GFX_FIXED(4.5));
+
+    app_p->popupTimer = SWTimer_construct(POPUP_TIME_MS);
+    SWTimer_start(&app_p->popupTimer);
+
+}
+
+void Application_closeBaudPopup(Application* app_p, GFX* gfx_p) {
+
+    if (!GFX_restoreUnder(gfx_p, &app_p->popup)) Board_invalidate(&app_p->board);
+    app_p->popupShown = false;
+
+}
+
 /**
  * Updates which LEDs are lit and what baud rate the UART module communicates
  * with, based on what the application's baud choice is at the time this
@@ -621,9 +772,22 @@ void Application_updateCommunications(Application* app_p, HAL* hal_p) {
         app_p->baudChoice = (UART_Baudrate)newBaudNumber;
     }
 
+    Application_setCommunications(app_p, hal_p);
+}
+
+/**
+ * Switches the UART to the application's baud choice, and shows the choice on
+ * the LEDs and, during a game, in a pop-up.
+ *
+ * @param app_p:  A pointer to the main Application object.
+ * @param hal_p:  A pointer to the main HAL object
+ */
+void Application_setCommunications(Application* app_p, HAL* hal_p) {
     // Start/update the baud rate according to the one set above.
     UART_SetBaud_Enable(&hal_p->uart, app_p->baudChoice);
 
+    if (app_p->state == GameScreen) Application_showBaudPopup(app_p, &hal_p->gfx);
+
     // Based on the new application choice, turn on the correct LED.
     // To make your life easier, we recommend turning off all LEDs before
     // selectively turning back on only the LEDs that need to be relit.
@@ -631,34 +795,16 @@ void Application_updateCommunications(Application* app_p, HAL* hal_p) {
     LED_turnOff(&hal_p->launchpadLED2Red);
     LED_turnOff(&hal_p->launchpadLED2Green);
     LED_turnOff(&hal_p->launchpadLED2Blue);
-
-    // TODO: Turn on all appropriate LEDs according to the tasks below.
-    switch (app_p->baudChoice) {
-    // When the baud rate is 9600, turn on Launchpad LED Red
-    case BAUD_9600:
-        LED_turnOn(&hal_p->launchpadLED2Red);
-        break;
-
-        // TODO: When the baud rate is 19200, turn on Launchpad LED Green
-    case BAUD_19200:
-        LED_turnOn(&hal_p->launchpadLED2Green);
-        break;
-
-        // TODO: When the baud rate is 38400, turn on Launchpad LED Blue
-    case BAUD_38400:
-        LED_turnOn(&hal_p->launchpadLED2Blue);
-        break;
-
-        // TODO: When the baud rate is 57600, turn on all Launchpad LEDs
-        // (illuminates white)
-    case BAUD_57600:
-        LED_turnOn(&hal_p->launchpadLED2Red);
-        LED_turnOn(&hal_p->launchpadLED2Green);
-        LED_turnOn(&hal_p->launchpadLED2Blue);
-        break;
-
-        // In the default case, this program will do nothing.
-    default:
-        break;
-    }
+    LED_turnOff(&hal_p->boosterpackRed);
+    LED_turnOff(&hal_p->boosterpackGreen);
+    LED_turnOff(&hal_p->boosterpackBlue);
+
+    // The baud choices go in groups of four. Launchpad LED2 shows the place in
+    // the group: red, green, blue, then white for the fourth, so 9600 to 57600
+    // light up as they always have. The BoosterPack LED shows the group the
+    // same way, staying off for the first one, so 115200 to 921600 add red.
+    ShowBaudColor(&hal_p->launchpadLED2Red, &hal_p->launchpadLED2Green, &hal_p->launchpadLED2Blue,
+                  app_p->baudChoice % BAUD_GROUP_SIZE + 1);
+    ShowBaudColor(&hal_p->boosterpackRed, &hal_p->boosterpackGreen, &hal_p->boosterpackBlue,
+                  app_p->baudChoice / BAUD_GROUP_SIZE);
 }
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""
+img2rle.py
+
+Converts an image into a run-length-encoded GFXImage asset (see
+HAL/Graphics.h) which can be drawn with GFX_drawImage().
+
+    python3 tools/img2rle.py splash.png assets/splash [--bpp 1|4|8]
+
+writes assets/splash.c and assets/splash.h declaring a GFXImage named after
+the output file. The image is reduced to at most 2, 16 or 256 colors for 1, 4
+or 8 bits per pixel; without --bpp the smallest depth that holds all of its
+colors is used. Requires Pillow.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+from PIL import Image
+
+MAX_RUN = 128
+
+
+def palettize(image, bpp):
+    """Returns (palette, indices) with the image reduced to 2**bpp colors."""
+    image = image.convert("RGB")
+    colors = image.getcolors(1 << bpp)
+    if colors is None:
+        image = image.quantize(colors=1 << bpp).convert("RGB")
+        colors = image.getcolors(1 << bpp)
+
+    palette = [rgb for _, rgb in sorted(colors, reverse=True)]
+    lookup = {rgb: i for i, rgb in enumerate(palette)}
+    pixels = image.tobytes()
+    indices = [lookup[tuple(pixels[i:i + 3])] for i in range(0, len(pixels), 3)]
+    return palette, indices
+
+
+def smallest_bpp(image):
+    count = len(image.convert("RGB").getcolors(1 << 24))
+    for bpp in (1, 4, 8):
+        if count <= 1 << bpp:
+            return bpp
+    return 8
+
+
+def pack(indices, bpp):
+    """Packs literal indices MSB first, padded to a whole byte."""
+    out = bytearray()
+    acc = bits = 0
+    for index in indices:
+        acc = (acc << bpp) | index
+        bits += bpp
+        if bits == 8:
+            out.append(acc)
+            acc = bits = 0
+    if bits:
+        out.append(acc << (8 - bits))
+    return out
+
+
+def encode(indices, bpp):
+    """Encodes palette indices as the runs understood by GFX_drawImage()."""
+    # A repeat run costs two bytes, so shorter runs are cheaper as literals
+    min_repeat = max(3, 16 // bpp + 1)
+
+    out = bytearray()
+    literals = []
+
+    def flush_literals():
+        while literals:
+            chunk = literals[:MAX_RUN]
+            del literals[:MAX_RUN]
+            out.append(0x80 | (len(chunk) - 1))
+            out.extend(pack(chunk, bpp))
+
+    i = 0
+    while i < len(indices):
+        j = i
+        while j < len(indices) and indices[j] == indices[i]:
+            j += 1
+
+        if j - i >= min_repeat:
+            flush_literals()
+            count = j - i
+            while count > 0:
+                chunk = min(count, MAX_RUN)
+                out.append(chunk - 1)
+                out.append(indices[i])
+                count -= chunk
+        else:
+            literals.extend(indices[i:j])
+        i = j
+
+    flush_literals()
+    return out
+
+
+def decode(runs, bpp, count):
+    """Reference decoder, used to check the encoder's output."""
+    indices = []
+    pos = 0
+    while len(indices) < count:
+        header = runs[pos]
+        pos += 1
+        n = (header & 0x7F) + 1
+        if header & 0x80:
+            for k in range(n):
+                bit = k * bpp
+                indices.append((runs[pos + bit // 8] >> (8 - bpp - bit % 8)) & ((1 << bpp) - 1))
+            pos += (n * bpp + 7) // 8
+        else:
+            indices.extend([runs[pos]] * n)
+            pos += 1
+    return indices
+
+
+def c_array(data, per_line):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append("    " + " ".join(data[i:i + per_line]))
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert an image into an RLE GFXImage asset")
+    parser.add_argument("image")
+    parser.add_argument("output", help="output path without extension")
+    parser.add_argument("--bpp", type=int, choices=(1, 4, 8))
+    args = parser.parse_args()
+
+    image = Image.open(args.image)
+    if image.width > 128 or image.height > 128:
+        sys.exit("img2rle: %s is larger than the 128x128 screen" % args.image)
+
+    bpp = args.bpp or smallest_bpp(image)
+    palette, indices = palettize(image, bpp)
+    runs = encode(indices, bpp)
+    assert decode(runs, bpp, len(indices)) == indices
+
+    name = re.sub(r"\W", "_", os.path.basename(args.output))
+    guard = name.upper() + "_H_"
+
+    with open(args.output + ".h", "w") as f:
+        f.write("/*\n * %s.h\n *\n * Generated by tools/img2rle.py from %s - do not edit.\n */\n\n"
+                % (name, os.path.basename(args.image)))
+        f.write("#ifndef %s\n#define %s\n\n#include <HAL/Graphics.h>\n\n" % (guard, guard))
+        f.write("extern const GFXImage %s;\n\n#endif /* %s */\n" % (name, guard))
+
+    with open(args.output + ".c", "w") as f:
+        f.write("/*\n * %s.c\n *\n * Generated by tools/img2rle.py from %s - do not edit.\n"
+                " * %dx%d, %d bpp, %d bytes of runs (%d uncompressed).\n */\n\n"
+                % (name, os.path.basename(args.image), image.width, image.height, bpp,
+                   len(runs), (len(indices) * bpp + 7) // 8))
+        f.write('#include "%s.h"\n\n' % name)
+        f.write("static const uint32_t %s_palette[] = {\n%s\n};\n\n"
+                % (name, c_array(["0x%06X," % ((r << 16) | (g << 8) | b) for r, g, b in palette], 6)))
+        f.write("static const uint8_t %s_runs[] = {\n%s\n};\n\n"
+                % (name, c_array(["0x%02X," % byte for byte in runs], 12)))
+        f.write("const GFXImage %s = { %d, %d, %d, %s_palette, %s_runs };\n"
+                % (name, bpp, image.width, image.height, name, name))
+
+    print("%s: %d bytes of runs for %d pixels at %d bpp"
+          % (args.output, len(runs), len(indices), bpp))
+
+
+if __name__ == "__main__":
+    main()